@@ -0,0 +1,69 @@
+/*
+ * Times OcsController::process() per sample. Only the controller's public
+ * interface is used, so the same file builds against older revisions of
+ * Source/ (see compare_revisions.sh). Every configuration runs the same
+ * noise plus 10 Hz tone and reports the best of REPS passes in ns/sample.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "OcsController.h"
+
+static const int SAMPLES = 60000;
+static const int REPS = 15;
+static const int RFS = 300;
+
+static double timeConfiguration(int engine, bool smooth, const std::vector<float>& input)
+{
+	OcsController controller;
+	controller.parameterValueChange("rfs", RFS);
+	controller.parameterValueChange("freq_low", 8);
+	controller.parameterValueChange("freq_high", 12);
+	controller.parameterValueChange("sdft_window_type", engine);
+	controller.parameterValueChange("sdft_window_size", 1);
+	controller.parameterValueChange("use_smooth", smooth ? 1 : 0);
+
+	double best = 1e30;
+	int sink = 0;
+	for (int rep = 0; rep < REPS; rep++) {
+		controller.clear_all();
+		auto start = std::chrono::steady_clock::now();
+		for (float sample : input) {
+			sink += std::get<0>(controller.process(sample));
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		best = std::min(best, seconds * 1e9 / input.size());
+	}
+	// keeps the results alive
+	if (sink == -1) {
+		std::printf("%d\n", sink);
+	}
+	return best;
+}
+
+int main()
+{
+	std::mt19937 rng(1);
+	std::normal_distribution<float> noise(0.0f, 1.0f);
+	std::vector<float> input(SAMPLES);
+	for (int i = 0; i < SAMPLES; i++) {
+		input[i] = noise(rng) + std::sin(2 * M_PI * 10.0 * i / RFS);
+	}
+
+	const char* names[] = { "", "Rectangle", "Exp", "ZeroPaddingExp", "MirrorExp" };
+	for (int engine = 1; engine <= 4; engine++) {
+		for (bool smooth : { false, true }) {
+			double ns = timeConfiguration(engine, smooth, input);
+			std::printf("RESULT %s %s %.1f\n", names[engine], smooth ? "on" : "off", ns);
+		}
+	}
+	return 0;
+}
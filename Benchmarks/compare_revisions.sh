@@ -0,0 +1,54 @@
+#!/bin/sh
+# Builds controller_benchmark against the Source/ of two revisions and runs
+# the two binaries alternately, so that load on a shared machine hits both
+# alike. Prints min / median over the runs of each configuration's best
+# pass, in ns/sample.
+#
+#   Benchmarks/compare_revisions.sh a3e9053^ a3e9053 6
+set -e
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 <revision a> <revision b> [runs]" >&2
+	exit 1
+fi
+RUNS=${3:-6}
+REPO=$(git rev-parse --show-toplevel)
+WORK=$(mktemp -d)
+trap 'git -C "$REPO" worktree remove --force "$WORK/a" 2>/dev/null; git -C "$REPO" worktree remove --force "$WORK/b" 2>/dev/null; rm -rf "$WORK"' EXIT
+
+for side in a b; do
+	if [ $side = a ]; then rev=$1; else rev=$2; fi
+	git -C "$REPO" worktree add --quiet --detach "$WORK/$side" "$rev" >/dev/null
+	cmake -S "$REPO/Benchmarks" -B "$WORK/build-$side" -DCMAKE_BUILD_TYPE=Release \
+		-DOCS_SOURCE_DIR="$WORK/$side/Source" >/dev/null
+	cmake --build "$WORK/build-$side" >/dev/null
+done
+
+run=0
+while [ $run -lt "$RUNS" ]; do
+	for side in a b; do
+		"$WORK/build-$side/controller_benchmark" | grep '^RESULT' | sed "s/^RESULT/$side/" >> "$WORK/results"
+	done
+	run=$((run + 1))
+done
+
+echo "engine smooth: $1 (min / median)  $2 (min / median)"
+sort -k2,2 -k3,3 -k1,1 -k4,4n "$WORK/results" | awk '
+	function report() {
+		if (key == "") return
+		line = key
+		for (s = 0; s < 2; s++) {
+			side = (s == 0) ? "a" : "b"
+			n = count[side]
+			median = (n % 2) ? v[side, (n + 1) / 2] : (v[side, n / 2] + v[side, n / 2 + 1]) / 2
+			line = line sprintf("  %.0f / %.0f", v[side, 1], median)
+		}
+		print line
+	}
+	{
+		k = $2 " " $3
+		if (k != key) { report(); key = k; count["a"] = 0; count["b"] = 0 }
+		count[$1]++
+		v[$1, count[$1]] = $4
+	}
+	END { report() }'
@@ -0,0 +1,290 @@
+#include "AdaptiveSpatialFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static const double COVARIANCE_TAU = 10.0;	// s
+static const double SOLVE_PERIOD = 2.0;		// s
+static const int POWER_ITERATIONS = 40;
+
+
+AdaptiveSpatialFilter::AdaptiveSpatialFilter() :
+	nChannels(0), freqLow(8), freqHigh(12), sampleRate(300), covarianceStep(3), generation(0),
+	job(nullptr), exiting(false), busy(false), solvedGeneration(-1),
+	latest(1), writeSlot(0), readSlot(2)
+{
+	configure();
+	worker = std::thread(&AdaptiveSpatialFilter::workerLoop, this);
+}
+
+AdaptiveSpatialFilter::~AdaptiveSpatialFilter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		exiting = true;
+	}
+	cv.notify_all();
+	worker.join();
+}
+
+void AdaptiveSpatialFilter::setChannels(int nChannels)
+{
+	this->nChannels = nChannels;
+	configure();
+}
+
+void AdaptiveSpatialFilter::setBand(double freqLow, double freqHigh, double sampleRate)
+{
+	this->freqLow = freqLow;
+	this->freqHigh = freqHigh;
+	this->sampleRate = sampleRate;
+	configure();
+}
+
+void AdaptiveSpatialFilter::setCovarianceStep(int step)
+{
+	covarianceStep = std::max(step, 1);
+	configure();
+}
+
+void AdaptiveSpatialFilter::clear()
+{
+	configure();
+}
+
+void AdaptiveSpatialFilter::configure()
+{
+	auto next = std::make_unique<Estimator>();
+	Estimator& e = *next;
+	e.nChannels = nChannels;
+	e.covarianceStep = covarianceStep;
+	e.forget = std::exp(-covarianceStep / (COVARIANCE_TAU * sampleRate));
+	e.solveInterval = std::max((int)(SOLVE_PERIOD * sampleRate / covarianceStep), 1);
+	e.frameCount = 0;
+	e.updateCount = 0;
+	e.generation = ++generation;
+	e.releasedNext = nullptr;
+
+	e.bandpass.setNumChannels(nChannels);
+	if (freqLow > 0 && freqLow < freqHigh && freqHigh < sampleRate / 2) {
+		e.bandpassDesign.setup(sampleRate, (freqLow + freqHigh) / 2.0, freqHigh - freqLow);
+		e.bandpass.setup(e.bandpassDesign);
+	}
+	else {
+		std::cout << "[Error] Adaptive spatial filter band " << freqLow << "-" << freqHigh
+			<< " Hz is not below Nyquist" << std::endl;
+	}
+
+	e.inBand.assign(nChannels, 0.0);
+	e.outBand.assign(nChannels, 0.0);
+	e.covIn.assign(nChannels * nChannels, 0.0);
+	e.covOut.assign(nChannels * nChannels, 0.0);
+	e.snapshotIn.assign(nChannels * nChannels, 0.0);
+	e.snapshotOut.assign(nChannels * nChannels, 0.0);
+	estimators.post(std::move(next));
+}
+
+void AdaptiveSpatialFilter::adoptEstimator()
+{
+	// the worker may be solving on the running estimator: swap only while it is idle
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (!lock.owns_lock() || busy) {
+		return;
+	}
+	Estimator* next = estimators.take();
+	if (next == nullptr) {
+		return;
+	}
+	estimators.release(estimator.release());
+	estimator.reset(next);
+	lock.unlock();
+	// weights of the old estimator that were never fetched
+	if (latest.load() & FRESH) {
+		readSlot = latest.exchange(readSlot) & 3;
+	}
+}
+
+void AdaptiveSpatialFilter::addFrame(const float* frame)
+{
+	if (estimators.hasPending()) {
+		adoptEstimator();
+	}
+	if (!estimator || estimator->nChannels == 0) {
+		return;
+	}
+	Estimator& e = *estimator;
+	for (int c = 0; c < e.nChannels; c++) {
+		e.inBand[c] = frame[c];
+	}
+	e.bandpass.filter(e.inBand.data());
+	for (int c = 0; c < e.nChannels; c++) {
+		e.outBand[c] = frame[c] - e.inBand[c];
+	}
+
+	if (++e.frameCount < e.covarianceStep) {
+		return;
+	}
+	e.frameCount = 0;
+	rankOneUpdate(e.covIn, e.inBand);
+	rankOneUpdate(e.covOut, e.outBand);
+
+	if (++e.updateCount >= e.solveInterval) {
+		e.updateCount = 0;
+		requestSolve();
+	}
+}
+
+void AdaptiveSpatialFilter::rankOneUpdate(std::vector<double>& cov, const std::vector<double>& x)
+{
+	// C = forget * C + x x^T, upper triangle only; the inner loop is contiguous
+	const int n = estimator->nChannels;
+	const double forget = estimator->forget;
+	const double* xp = x.data();
+	for (int i = 0; i < n; i++) {
+		double* row = cov.data() + i * n;
+		const double xi = xp[i];
+		for (int j = i; j < n; j++) {
+			row[j] = forget * row[j] + xi * xp[j];
+		}
+	}
+}
+
+void AdaptiveSpatialFilter::requestSolve()
+{
+	// never block the audio thread: skip this round if the worker is still busy
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (!lock.owns_lock() || busy) {
+		return;
+	}
+	// same sizes: a copy, no allocation
+	std::copy(estimator->covIn.begin(), estimator->covIn.end(), estimator->snapshotIn.begin());
+	std::copy(estimator->covOut.begin(), estimator->covOut.end(), estimator->snapshotOut.begin());
+	job = estimator.get();
+	busy = true;
+	lock.unlock();
+	cv.notify_all();
+}
+
+void AdaptiveSpatialFilter::workerLoop()
+{
+	while (true) {
+		Estimator* current;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv.wait(lock, [this] { return job != nullptr || exiting; });
+			if (exiting) {
+				return;
+			}
+			current = job;
+		}
+
+		const int n = current->nChannels;
+		if (current->generation != solvedGeneration) {
+			// a new estimator starts from the uniform filter
+			solvedGeneration = current->generation;
+			eigvec.assign(n, n > 0 ? 1.0 / std::sqrt((double)n) : 0.0);
+		}
+		if (solve(*current)) {
+			std::vector<float>& slot = slots[writeSlot];
+			slot.resize(n);
+			double norm = 0;
+			for (int i = 0; i < n; i++) norm += std::abs(eigvec[i]);
+			for (int i = 0; i < n; i++) slot[i] = (float)(eigvec[i] / norm);
+			writeSlot = latest.exchange(writeSlot | FRESH) & 3;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job = nullptr;
+			busy = false;
+		}
+		cv.notify_all();
+	}
+}
+
+bool AdaptiveSpatialFilter::solve(Estimator& job)
+{
+	const int n = job.nChannels;
+	if (n == 0) {
+		return false;
+	}
+	std::vector<double>& A = job.snapshotOut;
+	std::vector<double>& B = job.snapshotIn;
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < i; j++) {
+			A[i * n + j] = A[j * n + i];
+			B[i * n + j] = B[j * n + i];
+		}
+	}
+
+	double trace = 0;
+	for (int i = 0; i < n; i++) trace += A[i * n + i];
+	const double reg = 1e-3 * trace / n + 1e-12;
+	for (int i = 0; i < n; i++) A[i * n + i] += reg;
+
+	// A = L L^T
+	cholesky.assign(n * n, 0.0);
+	double* L = cholesky.data();
+	for (int j = 0; j < n; j++) {
+		double d = A[j * n + j];
+		for (int k = 0; k < j; k++) d -= L[j * n + k] * L[j * n + k];
+		if (d <= 0) {
+			return false;
+		}
+		const double ljj = std::sqrt(d);
+		L[j * n + j] = ljj;
+		for (int i = j + 1; i < n; i++) {
+			double s = A[i * n + j];
+			for (int k = 0; k < j; k++) s -= L[i * n + k] * L[j * n + k];
+			L[i * n + j] = s / ljj;
+		}
+	}
+
+	// power iteration on A^-1 B, warm-started from the previous solution
+	std::vector<double> previous = eigvec;
+	std::vector<double> w = eigvec;
+	tmp.assign(n, 0.0);
+	for (int iter = 0; iter < POWER_ITERATIONS; iter++) {
+		for (int i = 0; i < n; i++) {
+			const double* row = B.data() + i * n;
+			double s = 0;
+			for (int j = 0; j < n; j++) s += row[j] * w[j];
+			tmp[i] = s;
+		}
+		for (int i = 0; i < n; i++) {
+			double s = tmp[i];
+			for (int k = 0; k < i; k++) s -= L[i * n + k] * tmp[k];
+			tmp[i] = s / L[i * n + i];
+		}
+		for (int i = n - 1; i >= 0; i--) {
+			double s = tmp[i];
+			for (int k = i + 1; k < n; k++) s -= L[k * n + i] * w[k];
+			w[i] = s / L[i * n + i];
+		}
+		double norm = 0;
+		for (int i = 0; i < n; i++) norm += w[i] * w[i];
+		norm = std::sqrt(norm);
+		if (!(norm > 0)) {
+			return false;
+		}
+		for (int i = 0; i < n; i++) w[i] /= norm;
+	}
+
+	// keep the polarity stable between updates
+	double dot = 0;
+	for (int i = 0; i < n; i++) dot += w[i] * previous[i];
+	if (dot < 0) {
+		for (int i = 0; i < n; i++) w[i] = -w[i];
+	}
+	eigvec = w;
+	return true;
+}
+
+const std::vector<float>* AdaptiveSpatialFilter::fetchWeights()
+{
+	if (!(latest.load() & FRESH)) {
+		return nullptr;
+	}
+	readSlot = latest.exchange(readSlot) & 3;
+	return &slots[readSlot];
+}
@@ -0,0 +1,98 @@
+#ifndef ADAPTIVESPATIALFILTER_H
+#define ADAPTIVESPATIALFILTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Handoff.h"
+#include "iir/Butterworth.h"
+#include "iir/MultiChannel.h"
+
+
+/*
+ * Learns the spatial filter that maximizes in-band versus out-of-band power
+ * (largest generalized eigenvector of the two channel covariances).
+ * Covariances are updated on the audio thread at a reduced rate, the
+ * eigenproblem is solved on a worker thread and the weights are handed back
+ * through a lock-free triple buffer. Settings build a new estimator on the
+ * message thread, which the audio thread swaps in (Handoff) between solves.
+ */
+class AdaptiveSpatialFilter
+{
+public:
+	AdaptiveSpatialFilter();
+	~AdaptiveSpatialFilter();
+
+	// message thread
+	void setChannels(int nChannels);
+	void setBand(double freqLow, double freqHigh, double sampleRate);
+	void setCovarianceStep(int step);
+	void clear();
+
+	// audio thread: one decimated sample of every selected channel
+	void addFrame(const float* frame);
+
+	// audio thread: newest published weights, or nullptr when nothing new arrived
+	const std::vector<float>* fetchWeights();
+
+private:
+	// everything the audio thread updates, sized and designed up front
+	struct Estimator {
+		int nChannels;
+		int covarianceStep;
+		int solveInterval;
+		double forget;
+		int frameCount;
+		int updateCount;
+		long long generation;
+
+		// one design, applied to all channels in a single interleaved pass; double,
+		// as the decimated rate goes up to 44.1 kHz and the band can be a few Hz wide
+		Iir::Butterworth::BandPass<2> bandpassDesign;
+		Iir::MultiChannelCascade<double, 2> bandpass;
+		std::vector<double> inBand, outBand;
+		std::vector<double> covIn, covOut;		// nChannels x nChannels, upper triangle
+		std::vector<double> snapshotIn, snapshotOut;	// handed to the worker
+		Estimator* releasedNext;
+	};
+
+	void configure();
+	void adoptEstimator();
+	void rankOneUpdate(std::vector<double>& cov, const std::vector<double>& x);
+	void requestSolve();
+	void workerLoop();
+	bool solve(Estimator& job);
+
+	// message thread
+	int nChannels;
+	double freqLow, freqHigh, sampleRate;
+	int covarianceStep;
+	long long generation;
+	Handoff<Estimator> estimators;
+
+	// audio thread
+	std::unique_ptr<Estimator> estimator;
+
+	// worker side
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable cv;
+	Estimator* job;		// set with busy, not swapped out until the worker is done
+	bool exiting;
+	bool busy;
+	long long solvedGeneration;
+	std::vector<double> cholesky, eigvec, tmp;
+
+	// triple buffer, latest holds a slot index plus FRESH; the worker sizes the
+	// slot it writes, so a new channel count needs no reset
+	static const int FRESH = 4;
+	std::vector<float> slots[3];
+	std::atomic<int> latest;
+	int writeSlot;
+	int readSlot;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "ArtifactDetector.h"
+#include "iir/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+// counts[i] += 1 where x[i] breaks a limit; previous is the sample before x[0]
+IIR_SIMD_CLONES
+static void countArtifacts(const float* IIR_RESTRICT x, float previous, int n, float amplitude,
+	float derivative, float saturation, int* IIR_RESTRICT counts)
+{
+	if (n <= 0) {
+		return;
+	}
+	counts[0] += (std::fabs(x[0]) > amplitude) | (std::fabs(x[0] - previous) > derivative) | (std::fabs(x[0]) >= saturation);
+	for (int i = 1; i < n; i++) {
+		const float a = std::fabs(x[i]);
+		counts[i] += (a > amplitude) | (std::fabs(x[i] - x[i - 1]) > derivative) | (a >= saturation);
+	}
+}
+
+
+/* ArtifactDetector */
+ArtifactDetector::ArtifactDetector() :
+	nChannels(0), amplitudeLimit(0), derivativeLimit(0), saturationLevel(0), minChannels(1),
+	holdSamples(0), holdLeft(0), enabled(false), artifactCount(0), gatedSamples(0), samples(0)
+{
+}
+
+void ArtifactDetector::setup(int nChannels, const Limits& limits)
+{
+	this->nChannels = std::max(nChannels, 0);
+	lastSamples.assign(this->nChannels, 0.0f);
+	setLimits(limits);
+	clear();
+}
+
+void ArtifactDetector::setLimits(const Limits& limits)
+{
+	const float off = std::numeric_limits<float>::infinity();
+	amplitudeLimit = (limits.amplitude > 0) ? limits.amplitude : off;
+	derivativeLimit = (limits.derivative > 0) ? (float)(limits.derivative * 1000.0 / limits.sampleRate) : off;
+	saturationLevel = (limits.saturation > 0) ? limits.saturation : off;
+	minChannels = std::max(limits.minChannels, 1);
+	holdSamples = std::max((int)(limits.recovery * limits.sampleRate), std::max(limits.minHold, 1));
+	enabled = (limits.amplitude > 0) || (limits.derivative > 0) || (limits.saturation > 0);
+}
+
+void ArtifactDetector::clear()
+{
+	std::fill(lastSamples.begin(), lastSamples.end(), 0.0f);
+	std::fill(gated.begin(), gated.end(), 0);
+	holdLeft = 0;
+	artifactCount = 0;
+	gatedSamples = 0;
+	samples = 0;
+}
+
+void ArtifactDetector::process(const float* const* data, const std::vector<int>& channels, int nSamples)
+{
+	if ((int)gated.size() < nSamples) {
+		counts.resize(nSamples);
+		gated.resize(nSamples);
+	}
+	samples += nSamples;
+	if (!enabled || nSamples <= 0) {
+		std::fill(gated.begin(), gated.begin() + std::max(nSamples, 0), 0);
+		return;
+	}
+
+	std::fill(counts.begin(), counts.begin() + nSamples, 0);
+	const int n = std::min(nChannels, (int)channels.size());
+	for (int j = 0; j < n; j++) {
+		const float* x = data[channels[j]];
+		countArtifacts(x, lastSamples[j], nSamples, amplitudeLimit, derivativeLimit, saturationLevel, counts.data());
+		lastSamples[j] = x[nSamples - 1];
+	}
+
+	// the gate holds for holdSamples after the last artifact sample
+	for (int i = 0; i < nSamples; i++) {
+		if (counts[i] >= minChannels) {
+			if (holdLeft == 0) {
+				artifactCount++;
+			}
+			holdLeft = holdSamples;
+		}
+		else if (holdLeft > 0) {
+			holdLeft--;
+		}
+		gated[i] = (holdLeft > 0);
+		gatedSamples += gated[i];
+	}
+}
+
+bool ArtifactDetector::isGated(int sample) const
+{
+	return gated[sample] != 0;
+}
+
+long long ArtifactDetector::getArtifactCount() const
+{
+	return artifactCount;
+}
+
+long long ArtifactDetector::getGatedSamples() const
+{
+	return gatedSamples;
+}
+
+long long ArtifactDetector::getSamples() const
+{
+	return samples;
+}
@@ -0,0 +1,61 @@
+#ifndef ARTIFACTDETECTOR_H
+#define ARTIFACTDETECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+
+/*
+ * Full-rate artifact detection over the selected channels, before any
+ * decimation. A sample is an artifact when at least minChannels channels
+ * exceed the amplitude limit, jump by more than the derivative limit since
+ * the previous sample, or sit at the saturation level. Each channel is one
+ * contiguous, vectorized pass over the block that adds to a per-sample
+ * count; the recovery hold is one scalar pass over the counts. Detection
+ * is gated from the first artifact sample until the recovery has passed
+ * after the last one.
+ */
+class ArtifactDetector
+{
+public:
+	ArtifactDetector();
+
+	// limits in the units of the data; the derivative per ms; 0 turns a test
+	// off. The recovery is in s and never shorter than minHold samples.
+	struct Limits
+	{
+		double sampleRate;
+		float amplitude, derivative, saturation;
+		int minChannels;
+		double recovery;
+		int minHold;
+	};
+
+	void setup(int nChannels, const Limits& limits);
+	// in place: the last samples, a running hold and the counts carry on
+	void setLimits(const Limits& limits);
+	void clear();
+
+	// data[channels[j]][start + i] is sample i of selected channel j
+	void process(const float* const* data, const std::vector<int>& channels, int nSamples);
+	// sample i of the last block
+	bool isGated(int sample) const;
+
+	long long getArtifactCount() const;		// artifacts that started a gate
+	long long getGatedSamples() const;
+	long long getSamples() const;
+
+private:
+	int nChannels;
+	float amplitudeLimit, derivativeLimit, saturationLevel;	// per sample, infinity when off
+	int minChannels;
+	int holdSamples, holdLeft;
+	bool enabled;
+
+	std::vector<float> lastSamples;	// per channel, for the derivative across blocks
+	std::vector<int> counts;		// per sample of the block
+	std::vector<uint8_t> gated;
+	long long artifactCount, gatedSamples, samples;
+};
+
+#endif
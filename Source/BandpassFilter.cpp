@@ -0,0 +1,133 @@
+#include "BandpassFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static const int MAX_FIR_TAPS = 1025;
+static const char* DESIGN_NAMES[] = { "Auto", "Butterworth", "Bessel", "Resonator", "Linear phase FIR", "Minimum phase FIR" };
+
+
+BandpassFilter::BandpassFilter() :
+	design(BandpassDesign::BUTTERWORTH), sampleRate(300), evalFrequency(10), delayBudget(0)
+{
+}
+
+void BandpassFilter::setup(BandpassDesign design, double sampleRate, double freqLow, double freqHigh,
+	double evalFrequency, double delayBudget)
+{
+	// unrelated parameter changes must not restart the filter
+	std::vector<double> request = { (double)design, sampleRate, freqLow, freqHigh, evalFrequency, delayBudget };
+	if (request == lastRequest) {
+		return;
+	}
+	lastRequest = request;
+
+	this->sampleRate = sampleRate;
+	this->evalFrequency = std::min(std::max(evalFrequency, 0.0), sampleRate / 2);
+	this->delayBudget = delayBudget;
+
+	const double center = (freqLow + freqHigh) / 2.0;
+	const double width = freqHigh - freqLow;
+	butterworth.setup(sampleRate, center, width);
+	bessel.setup(sampleRate, center, width);
+
+	// the FIR is as long as the narrower of the low edge and the band needs
+	int taps = std::min(Iir::FIR::BandPass::numTapsForTransition(std::min(freqLow, width) / sampleRate), MAX_FIR_TAPS);
+	minimumFir.setup(sampleRate, center, width, taps, true);
+	const double budgetSamples = delayBudget * sampleRate / 1000.0;
+	const bool firFits = (taps - 1) / 2.0 <= budgetSamples;
+	if (delayBudget > 0 && !firFits) {
+		taps = 2 * (int)budgetSamples + 1;
+	}
+	fir.setup(sampleRate, center, width, taps);
+
+	// RBJ bandwidth is in octaves around the geometric centre
+	if (freqLow > 0) {
+		fitResonator(std::sqrt(freqLow * freqHigh), std::log2(freqHigh / freqLow));
+	}
+	else {
+		fitResonator(center, 1.0);
+	}
+
+	if (design == BandpassDesign::AUTO_BANDPASS) {
+		if (delayBudget <= 0) {
+			design = BandpassDesign::BUTTERWORTH;
+		}
+		else if (groupDelay(BandpassDesign::BESSEL) <= delayBudget) {
+			design = BandpassDesign::BESSEL;
+		}
+		else if (groupDelay(BandpassDesign::BUTTERWORTH) <= delayBudget) {
+			design = BandpassDesign::BUTTERWORTH;
+		}
+		else if (firFits) {
+			design = BandpassDesign::LINEAR_FIR;
+		}
+		else if (groupDelay(BandpassDesign::MINIMUM_FIR) <= delayBudget) {
+			design = BandpassDesign::MINIMUM_FIR;
+		}
+		else {
+			design = BandpassDesign::RESONATOR;
+		}
+	}
+	this->design = design;
+	reset();
+
+	std::cout << "Bandpass: " << DESIGN_NAMES[design] << ", group delay " << getGroupDelay()
+		<< " ms at " << this->evalFrequency << " Hz" << std::endl;
+	if (delayBudget > 0 && getGroupDelay() > delayBudget) {
+		std::cout << "[Error] Bandpass delay exceeds the budget of " << delayBudget << " ms" << std::endl;
+	}
+}
+
+void BandpassFilter::fitResonator(double center, double octaves)
+{
+	// a single biquad; if it is still too slow, widen it until it fits
+	resonator.setup(sampleRate, center, octaves);
+	while (delayBudget > 0 && groupDelay(BandpassDesign::RESONATOR) > delayBudget && octaves < 8) {
+		octaves *= 1.25;
+		resonator.setup(sampleRate, center, octaves);
+	}
+}
+
+void BandpassFilter::reset()
+{
+	butterworth.reset();
+	bessel.reset();
+	resonator.reset();
+	fir.reset();
+	minimumFir.reset();
+}
+
+double BandpassFilter::groupDelay(BandpassDesign design) const
+{
+	const double f = evalFrequency / sampleRate;
+	double samples;
+	switch (design) {
+	case BandpassDesign::BESSEL:
+		samples = bessel.groupDelay(f);
+		break;
+	case BandpassDesign::RESONATOR:
+		samples = resonator.groupDelay(f);
+		break;
+	case BandpassDesign::LINEAR_FIR:
+		samples = fir.groupDelay(f);
+		break;
+	case BandpassDesign::MINIMUM_FIR:
+		samples = minimumFir.groupDelay(f);
+		break;
+	default:
+		samples = butterworth.groupDelay(f);
+		break;
+	}
+	return samples * 1000.0 / sampleRate;
+}
+
+BandpassDesign BandpassFilter::getDesign() const
+{
+	return design;
+}
+
+double BandpassFilter::getGroupDelay() const
+{
+	return groupDelay(design);
+}
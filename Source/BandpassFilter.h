@@ -0,0 +1,65 @@
+#ifndef BANDPASSFILTER_H
+#define BANDPASSFILTER_H
+
+#include "iir/Butterworth.h"
+#include "iir/Bessel.h"
+#include "iir/RBJ.h"
+#include "iir/FIR.h"
+
+#include <vector>
+
+
+enum BandpassDesign { AUTO_BANDPASS = 0, BUTTERWORTH, BESSEL, RESONATOR, LINEAR_FIR, MINIMUM_FIR };
+
+/*
+ * Pre-detection bandpass with a choice of designs. Each design reports its
+ * group delay at the frequency of interest, and AUTO_BANDPASS picks the most
+ * selective design whose delay fits the budget.
+ */
+class BandpassFilter
+{
+public:
+	BandpassFilter();
+
+	// delayBudget in ms, 0 means no budget; evalFrequency is where the delay is measured
+	void setup(BandpassDesign design, double sampleRate, double freqLow, double freqHigh,
+		double evalFrequency, double delayBudget);
+	void reset();
+
+	inline float filter(float sample);
+
+	BandpassDesign getDesign() const;
+	double getGroupDelay() const;	// ms at evalFrequency
+
+private:
+	double groupDelay(BandpassDesign design) const;
+	void fitResonator(double center, double octaves);
+
+	BandpassDesign design;
+	std::vector<double> lastRequest;
+	double sampleRate, evalFrequency, delayBudget;
+
+	Iir::Butterworth::BandPass<1> butterworth;
+	Iir::Bessel::BandPass<2> bessel;
+	Iir::RBJ::BandPass2 resonator;
+	Iir::FIR::BandPass fir;
+	Iir::FIR::BandPass minimumFir;
+};
+
+inline float BandpassFilter::filter(float sample)
+{
+	switch (design) {
+	case BandpassDesign::BESSEL:
+		return bessel.filter(sample);
+	case BandpassDesign::RESONATOR:
+		return resonator.filter(sample);
+	case BandpassDesign::LINEAR_FIR:
+		return fir.filter(sample);
+	case BandpassDesign::MINIMUM_FIR:
+		return minimumFir.filter(sample);
+	default:
+		return butterworth.filter(sample);
+	}
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include "ChannelCoherence.h"
+#include "iir/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+static const double COHERENCE_FLOOR = 1e-30;	// |X|^2 of a silent channel
+
+
+// s += alpha (a conj(b) - s) for the cross-spectrum, the auto-spectra and the
+// unit phasor of a conj(b), over all pairs
+IIR_SIMD_CLONES
+static void averagePairs(int n, double alpha, const double* aRe, const double* aIm, const double* bRe, const double* bIm,
+	double* crossRe, double* crossIm, double* powerA, double* powerB, double* phasorRe, double* phasorIm)
+{
+	for (int p = 0; p < n; p++) {
+		const double re = aRe[p] * bRe[p] + aIm[p] * bIm[p];
+		const double im = aIm[p] * bRe[p] - aRe[p] * bIm[p];
+		const double pa = aRe[p] * aRe[p] + aIm[p] * aIm[p];
+		const double pb = bRe[p] * bRe[p] + bIm[p] * bIm[p];
+		crossRe[p] += alpha * (re - crossRe[p]);
+		crossIm[p] += alpha * (im - crossIm[p]);
+		powerA[p] += alpha * (pa - powerA[p]);
+		powerB[p] += alpha * (pb - powerB[p]);
+		const double norm = 1.0 / std::sqrt(std::max(pa * pb, COHERENCE_FLOOR));
+		phasorRe[p] += alpha * (re * norm - phasorRe[p]);
+		phasorIm[p] += alpha * (im * norm - phasorIm[p]);
+	}
+}
+
+
+/* ChannelCoherence */
+ChannelCoherence::ChannelCoherence() : alpha(1), measure(Measure::COHERENCE), threshold(0), hops(0), warmupHops(1)
+{
+}
+
+std::vector<ChannelCoherence::Pair> ChannelCoherence::parsePairs(const std::string& text)
+{
+	// "0-4,1-5" -> channel 0 with 4, channel 1 with 5
+	std::vector<Pair> pairs;
+	std::stringstream pairStream(text);
+	std::string item;
+	while (std::getline(pairStream, item, ',')) {
+		if (item.find_first_not_of(" ") == std::string::npos) {
+			continue;
+		}
+		size_t dash = item.find('-', item.find_first_not_of(" ") + 1);
+		try {
+			if (dash == std::string::npos) {
+				throw std::invalid_argument(item);
+			}
+			pairs.push_back({ std::stoi(item.substr(0, dash)), std::stoi(item.substr(dash + 1)) });
+		}
+		catch (const std::logic_error&) {
+			std::cout << "[Error] Invalid coherence pair: " << item << std::endl;
+			return {};
+		}
+	}
+	return pairs;
+}
+
+void ChannelCoherence::setPairs(const std::vector<Pair>& pairs, int nChannels)
+{
+	this->pairs.clear();
+	for (const Pair& pair : pairs) {
+		if (pair.a >= 0 && pair.a < nChannels && pair.b >= 0 && pair.b < nChannels && pair.a != pair.b) {
+			this->pairs.push_back(pair);
+		}
+	}
+	const int n = (int)this->pairs.size();
+	for (std::vector<double>* v : { &aRe, &aIm, &bRe, &bIm, &crossRe, &crossIm, &powerA, &powerB, &phasorRe, &phasorIm }) {
+		v->assign(n, 0.0);
+	}
+	pairOn.assign(n, 0);
+	pairChanged.assign(n, 0);
+}
+
+void ChannelCoherence::setup(double hopRate, double timeConstant, Measure measure, double threshold)
+{
+	alpha = (timeConstant > 0 && hopRate > 0) ? 1.0 - std::exp(-1.0 / (hopRate * timeConstant)) : 1.0;
+	warmupHops = std::max((int)std::ceil(hopRate * timeConstant), 1);
+	this->measure = measure;
+	this->threshold = threshold;
+	// a pair that is on goes off with an event on the next hop, if it has to
+	std::fill(pairChanged.begin(), pairChanged.end(), 0);
+}
+
+void ChannelCoherence::clear()
+{
+	for (std::vector<double>* v : { &crossRe, &crossIm, &powerA, &powerB, &phasorRe, &phasorIm }) {
+		std::fill(v->begin(), v->end(), 0.0);
+	}
+	hops = 0;
+	std::fill(pairOn.begin(), pairOn.end(), 0);
+	std::fill(pairChanged.begin(), pairChanged.end(), 0);
+}
+
+void ChannelCoherence::addHop(const std::complex<double>* bins)
+{
+	const int n = (int)pairs.size();
+	for (int p = 0; p < n; p++) {
+		aRe[p] = bins[pairs[p].a].real();
+		aIm[p] = bins[pairs[p].a].imag();
+		bRe[p] = bins[pairs[p].b].real();
+		bIm[p] = bins[pairs[p].b].imag();
+	}
+	averagePairs(n, alpha, aRe.data(), aIm.data(), bRe.data(), bIm.data(),
+		crossRe.data(), crossIm.data(), powerA.data(), powerB.data(), phasorRe.data(), phasorIm.data());
+
+	if (++hops < warmupHops) {
+		return;
+	}
+	for (int p = 0; p < n; p++) {
+		const double value = (measure == Measure::PLV) ? getPLV(p) : getCoherence(p);
+		const uint8_t on = (threshold > 0) && (value >= threshold);
+		pairChanged[p] = (on != pairOn[p]);
+		pairOn[p] = on;
+	}
+}
+
+int ChannelCoherence::getNumPairs() const
+{
+	return (int)pairs.size();
+}
+
+const ChannelCoherence::Pair& ChannelCoherence::getPair(int pair) const
+{
+	return pairs[pair];
+}
+
+double ChannelCoherence::getCoherence(int pair) const
+{
+	const double cross = crossRe[pair] * crossRe[pair] + crossIm[pair] * crossIm[pair];
+	return cross / std::max(powerA[pair] * powerB[pair], COHERENCE_FLOOR);
+}
+
+double ChannelCoherence::getPLV(int pair) const
+{
+	return std::sqrt(phasorRe[pair] * phasorRe[pair] + phasorIm[pair] * phasorIm[pair]);
+}
+
+double ChannelCoherence::getPhase(int pair) const
+{
+	return std::atan2(crossIm[pair], crossRe[pair]);
+}
+
+bool ChannelCoherence::isPairOn(int pair) const
+{
+	return pairOn[pair] != 0;
+}
+
+bool ChannelCoherence::hasPairChanged(int pair) const
+{
+	return pairChanged[pair] != 0;
+}
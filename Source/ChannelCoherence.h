@@ -0,0 +1,65 @@
+#ifndef CHANNELCOHERENCE_H
+#define CHANNELCOHERENCE_H
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*
+ * Running coherence and phase locking of channel pairs at the detection
+ * band. Every hop takes one complex band amplitude per channel and updates,
+ * per pair, the exponentially averaged cross-spectrum X conj(Y), the two
+ * auto-spectra and the mean unit phasor of the phase difference. Pairs are
+ * gathered into contiguous arrays first, so the averaging is one vectorized
+ * pass of a complex multiply-accumulate per pair.
+ */
+class ChannelCoherence
+{
+public:
+	enum Measure { COHERENCE = 0, PLV };
+
+	struct Pair {
+		int a, b;	// indices into the selected channels
+	};
+
+	ChannelCoherence();
+
+	// "a-b,a-b,..."
+	static std::vector<Pair> parsePairs(const std::string& text);
+	// pairs with a channel that is not selected are dropped
+	void setPairs(const std::vector<Pair>& pairs, int nChannels);
+	// averaging time constant in s at hopRate updates per s; a pair is on
+	// while its measure is at or above threshold (0: never), after one time
+	// constant of hops, since a short average is biased towards 1. Keeps the
+	// running averages, so it may be called between hops
+	void setup(double hopRate, double timeConstant, Measure measure, double threshold);
+	void clear();
+
+	// one band amplitude per selected channel, as ComplexDemodulator gives them
+	void addHop(const std::complex<double>* bins);
+
+	int getNumPairs() const;
+	const Pair& getPair(int pair) const;
+	double getCoherence(int pair) const;	// magnitude squared, 0..1
+	double getPLV(int pair) const;			// 0..1
+	double getPhase(int pair) const;		// mean phase of a over b, radians
+	bool isPairOn(int pair) const;
+	bool hasPairChanged(int pair) const;	// on the last hop
+
+private:
+	std::vector<Pair> pairs;
+	double alpha;
+	Measure measure;
+	double threshold;
+	int hops;
+	int warmupHops;
+
+	// gathered amplitudes and running averages, one entry per pair
+	std::vector<double> aRe, aIm, bRe, bIm;
+	std::vector<double> crossRe, crossIm, powerA, powerB, phasorRe, phasorIm;
+	std::vector<uint8_t> pairOn, pairChanged;
+};
+
+#endif
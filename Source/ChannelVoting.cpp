@@ -0,0 +1,194 @@
+#include "ChannelVoting.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+
+/* ChannelVoting */
+ChannelVoting::ChannelVoting() :
+	nChannels(0), autoThreshold(false), powerDomain(false), stdThreshold(1), powerCount(0)
+{
+}
+
+std::vector<ChannelVoting::Group> ChannelVoting::parseGroups(const std::string& text)
+{
+	// "2:0,1,2;3:4,5,6,7" -> 2 of channels 0-2, 3 of channels 4-7
+	std::vector<Group> groups;
+	std::stringstream groupStream(text);
+	std::string item;
+	while (std::getline(groupStream, item, ';')) {
+		if (item.find_first_not_of(" ") == std::string::npos) {
+			continue;
+		}
+		size_t colon = item.find(':');
+		Group group;
+		try {
+			if (colon == std::string::npos) {
+				throw std::invalid_argument(item);
+			}
+			group.k = std::stoi(item.substr(0, colon));
+			std::stringstream channelStream(item.substr(colon + 1));
+			std::string channel;
+			while (std::getline(channelStream, channel, ',')) {
+				group.channels.push_back(std::stoi(channel));
+			}
+		}
+		catch (const std::logic_error&) {
+			std::cout << "[Error] Invalid vote group: " << item << std::endl;
+			return {};
+		}
+		if (group.k > 0 && !group.channels.empty()) {
+			groups.push_back(group);
+		}
+	}
+	return groups;
+}
+
+void ChannelVoting::setupGroups(Groups& out, const std::vector<Group>& groups, int nChannels)
+{
+	out.list = groups;
+	out.words = (nChannels + 63) / 64;
+	const int nGroups = (int)groups.size();
+	out.masks.assign(nGroups * out.words, 0);
+	out.ks.resize(nGroups);
+	out.votes.assign(nGroups, 0);
+	out.groupOn.assign(nGroups, 0);
+	out.groupChanged.assign(nGroups, 0);
+	for (int g = 0; g < nGroups; g++) {
+		out.ks[g] = groups[g].k;
+		for (int channel : groups[g].channels) {
+			// channels that are not selected never vote
+			if (channel >= 0 && channel < nChannels) {
+				out.masks[g * out.words + channel / 64] |= (uint64_t)1 << (channel % 64);
+			}
+		}
+	}
+}
+
+void ChannelVoting::setGroups(const std::vector<Group>& groups)
+{
+	setupGroups(this->groups, groups, nChannels);
+}
+
+void ChannelVoting::swapGroups(Groups& groups)
+{
+	std::swap(this->groups, groups);
+}
+
+void ChannelVoting::setup(int nChannels, double sampleRate, double fmin, double fmax, int windowLength, int hop,
+	int twindow, bool autoThreshold, double stdThreshold, double threshold, bool powerDomain)
+{
+	this->nChannels = std::max(nChannels, 0);
+	this->autoThreshold = autoThreshold;
+	this->stdThreshold = stdThreshold;
+	this->powerDomain = powerDomain;
+
+	// as RealtimeDemodulator: the CIC is 3 dB down at half the band width
+	double width = std::min(std::max(fmax - fmin, sampleRate / std::max(windowLength, 1)), 0.45 * sampleRate);
+	int cicLength = std::max((int)std::lround(0.64 * sampleRate / width), 1);
+	demodulator.setup(this->nChannels, sampleRate, (fmin + fmax) / 2.0, cicLength, hop);
+
+	power.assign(this->nChannels, 0.0);
+	thresholds.assign(this->nChannels, threshold);
+	powerCount = 0;
+	powerMean.assign(this->nChannels, 0.0);
+	powerM2.assign(this->nChannels, 0.0);
+	crossings.resize(this->nChannels, twindow, OnsetDetector::COUNTER, 0, threshold);
+	setupGroups(groups, groups.list, this->nChannels);
+}
+
+void ChannelVoting::setThreshold(bool autoThreshold, double stdThreshold, double threshold)
+{
+	this->autoThreshold = autoThreshold;
+	this->stdThreshold = stdThreshold;
+	if (!autoThreshold) {
+		std::fill(thresholds.begin(), thresholds.end(), threshold);
+		crossings.setThreshold(threshold);
+	}
+}
+
+void ChannelVoting::clear()
+{
+	demodulator.reset();
+	powerCount = 0;
+	std::fill(powerMean.begin(), powerMean.end(), 0.0);
+	std::fill(powerM2.begin(), powerM2.end(), 0.0);
+	crossings.clear();
+	std::fill(groups.votes.begin(), groups.votes.end(), 0);
+	std::fill(groups.groupOn.begin(), groups.groupOn.end(), 0);
+	std::fill(groups.groupChanged.begin(), groups.groupChanged.end(), 0);
+}
+
+bool ChannelVoting::process(const float* frame)
+{
+	if (!demodulator.process(frame)) {
+		return false;
+	}
+	if (groups.ks.empty()) {
+		return true;
+	}
+	// amplitude / 2, read like the band power of an SDFT
+	const std::complex<double>* output = demodulator.getOutput();
+	for (int c = 0; c < nChannels; c++) {
+		power[c] = powerDomain ? std::norm(output[c]) : std::abs(output[c]);
+	}
+	if (autoThreshold) {
+		powerCount++;
+		for (int c = 0; c < nChannels; c++) {
+			double delta = power[c] - powerMean[c];
+			powerMean[c] += delta / powerCount;
+			powerM2[c] += delta * (power[c] - powerMean[c]);
+			double variance = (powerCount < 2) ? 0.0001 : powerM2[c] / (powerCount - 1);
+			thresholds[c] = powerMean[c] + stdThreshold * std::sqrt(variance);
+		}
+		crossings.setThresholds(thresholds.data(), nChannels);
+	}
+	crossings.addSamples(power.data(), nChannels);
+
+	const uint64_t* up = crossings.getWords();
+	const int words = groups.words;
+	for (int g = 0; g < (int)groups.ks.size(); g++) {
+		const uint64_t* mask = &groups.masks[g * words];
+		int count = 0;
+		for (int w = 0; w < words; w++) {
+			count += (int)std::bitset<64>(up[w] & mask[w]).count();
+		}
+		const uint8_t on = (count >= groups.ks[g]);
+		groups.groupChanged[g] = (on != groups.groupOn[g]);
+		groups.groupOn[g] = on;
+		groups.votes[g] = count;
+	}
+	return true;
+}
+
+int ChannelVoting::getNumGroups() const
+{
+	return (int)groups.ks.size();
+}
+
+bool ChannelVoting::isGroupOn(int group) const
+{
+	return groups.groupOn[group] != 0;
+}
+
+bool ChannelVoting::hasGroupChanged(int group) const
+{
+	return groups.groupChanged[group] != 0;
+}
+
+int ChannelVoting::getVotes(int group) const
+{
+	return groups.votes[group];
+}
+
+const std::complex<double>* ChannelVoting::getBins() const
+{
+	return demodulator.getOutput();
+}
+
+std::complex<double> ChannelVoting::getOscillator() const
+{
+	return demodulator.getOscillator();
+}
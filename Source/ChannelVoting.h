@@ -0,0 +1,82 @@
+#ifndef CHANNELVOTING_H
+#define CHANNELVOTING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ComplexDemodulator.h"
+#include "SwitchController.h"
+
+
+/*
+ * K-of-N voting across the selected channels. Every channel gets its own
+ * band power, by complex demodulation with one output per hop, and its own
+ * threshold crossing (CrossingBank). A group of channels is on while at
+ * least K of them are up: one AND and popcount of the crossing words per
+ * 64 channels of the group and hop. The band amplitudes of every hop are
+ * also the per-channel state for ChannelCoherence and the phase band of
+ * PhaseAmplitudeCoupling.
+ */
+class ChannelVoting
+{
+public:
+	struct Group {
+		int k;
+		std::vector<int> channels;	// indices into the selected channels
+	};
+
+	// the groups as channel masks, built off to the side and put in place by swapGroups()
+	struct Groups {
+		std::vector<Group> list;
+		int words = 0;
+		std::vector<uint64_t> masks;	// groups x words
+		std::vector<int> ks, votes;
+		std::vector<uint8_t> groupOn, groupChanged;
+	};
+
+	ChannelVoting();
+
+	// "k:c,c,...;k:c,..." -> one group per ';'
+	static std::vector<Group> parseGroups(const std::string& text);
+	static void setupGroups(Groups& out, const std::vector<Group>& groups, int nChannels);
+	void setGroups(const std::vector<Group>& groups);
+	// takes groups set up for this stage's channel count, without allocating;
+	// the band powers and their statistics are kept
+	void swapGroups(Groups& groups);
+
+	// twindow in hops; autoThreshold: mean + stdThreshold STD of each channel's power
+	void setup(int nChannels, double sampleRate, double fmin, double fmax, int windowLength, int hop,
+		int twindow, bool autoThreshold, double stdThreshold, double threshold, bool powerDomain);
+	// keeps the learned statistics
+	void setThreshold(bool autoThreshold, double stdThreshold, double threshold);
+	void clear();
+
+	// one decimated sample of every selected channel; true on a hop, when the votes are new
+	bool process(const float* frame);
+
+	int getNumGroups() const;
+	bool isGroupOn(int group) const;
+	bool hasGroupChanged(int group) const;	// on the last hop
+	int getVotes(int group) const;
+	// A/2 exp(j phase) of every selected channel on the last hop
+	const std::complex<double>* getBins() const;
+	// of the demodulator, to turn the bins into band phases
+	std::complex<double> getOscillator() const;
+
+private:
+	int nChannels;
+	bool autoThreshold, powerDomain;
+	double stdThreshold;
+
+	ComplexDemodulator demodulator;
+	std::vector<double> power, thresholds;
+	// running mean and variance of every channel's power, as RealtimeSTD
+	long long powerCount;
+	std::vector<double> powerMean, powerM2;
+	CrossingBank crossings;
+
+	Groups groups;
+};
+
+#endif
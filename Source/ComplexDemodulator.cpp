@@ -0,0 +1,132 @@
+#include "ComplexDemodulator.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const double FIXED_POINT_SCALE = 1048576.0;	// 2^20, leaves 2^43 / windowLength^2 of amplitude headroom
+static const int RENORMALIZE_PERIOD = 1024;
+
+
+/* ComplexDemodulator */
+ComplexDemodulator::ComplexDemodulator() :
+	nChannels(0), decimation(1), combDelay(1), windowLength(1),
+	phaseCount(0), slot(0), renormCount(0), normalization(1),
+	oscillator(1.0, 0.0), step(1.0, 0.0)
+{
+}
+
+void ComplexDemodulator::setup(int nChannels, double sampleRate, double center, int windowLength, int decimation)
+{
+	this->nChannels = std::max(nChannels, 0);
+	this->decimation = std::max(decimation, 1);
+	combDelay = std::max((int)std::lround((double)windowLength / this->decimation), 1);
+	this->windowLength = combDelay * this->decimation;
+	normalization = 1.0 / (FIXED_POINT_SCALE * this->windowLength * (double)this->windowLength);
+	step = std::polar(1.0, 2.0 * M_PI * center / sampleRate);
+
+	integratorRe1.assign(this->nChannels, 0);
+	integratorRe2.assign(this->nChannels, 0);
+	integratorIm1.assign(this->nChannels, 0);
+	integratorIm2.assign(this->nChannels, 0);
+	combRe1.assign(combDelay * this->nChannels, 0);
+	combRe2.assign(combDelay * this->nChannels, 0);
+	combIm1.assign(combDelay * this->nChannels, 0);
+	combIm2.assign(combDelay * this->nChannels, 0);
+	output.assign(this->nChannels, std::complex<double>(0));
+	reset();
+}
+
+void ComplexDemodulator::reset()
+{
+	std::fill(integratorRe1.begin(), integratorRe1.end(), 0);
+	std::fill(integratorRe2.begin(), integratorRe2.end(), 0);
+	std::fill(integratorIm1.begin(), integratorIm1.end(), 0);
+	std::fill(integratorIm2.begin(), integratorIm2.end(), 0);
+	std::fill(combRe1.begin(), combRe1.end(), 0);
+	std::fill(combRe2.begin(), combRe2.end(), 0);
+	std::fill(combIm1.begin(), combIm1.end(), 0);
+	std::fill(combIm2.begin(), combIm2.end(), 0);
+	std::fill(output.begin(), output.end(), std::complex<double>(0));
+	oscillator = std::complex<double>(1.0, 0.0);
+	phaseCount = 0;
+	slot = 0;
+	renormCount = 0;
+}
+
+bool ComplexDemodulator::process(const float* frame)
+{
+	// x exp(-j w t), quantized; unsigned wrap-around is exact for the CIC
+	const double c = oscillator.real() * FIXED_POINT_SCALE;
+	const double s = -oscillator.imag() * FIXED_POINT_SCALE;
+	uint64_t* re1 = integratorRe1.data();
+	uint64_t* re2 = integratorRe2.data();
+	uint64_t* im1 = integratorIm1.data();
+	uint64_t* im2 = integratorIm2.data();
+	for (int ch = 0; ch < nChannels; ch++) {
+		const double x = frame[ch];
+		re1[ch] += (uint64_t)(int64_t)(x * c);
+		im1[ch] += (uint64_t)(int64_t)(x * s);
+		re2[ch] += re1[ch];
+		im2[ch] += im1[ch];
+	}
+
+	oscillator *= step;
+	if (++renormCount == RENORMALIZE_PERIOD) {
+		renormCount = 0;
+		oscillator /= std::abs(oscillator);
+	}
+
+	if (++phaseCount < decimation) {
+		return false;
+	}
+	phaseCount = 0;
+
+	uint64_t* dRe1 = combRe1.data() + slot * nChannels;
+	uint64_t* dRe2 = combRe2.data() + slot * nChannels;
+	uint64_t* dIm1 = combIm1.data() + slot * nChannels;
+	uint64_t* dIm2 = combIm2.data() + slot * nChannels;
+	for (int ch = 0; ch < nChannels; ch++) {
+		const uint64_t cRe1 = re2[ch] - dRe1[ch];
+		const uint64_t cIm1 = im2[ch] - dIm1[ch];
+		dRe1[ch] = re2[ch];
+		dIm1[ch] = im2[ch];
+		const uint64_t cRe2 = cRe1 - dRe2[ch];
+		const uint64_t cIm2 = cIm1 - dIm2[ch];
+		dRe2[ch] = cRe1;
+		dIm2[ch] = cIm1;
+		output[ch] = std::complex<double>((double)(int64_t)cRe2 * normalization, (double)(int64_t)cIm2 * normalization);
+	}
+	if (++slot == combDelay) {
+		slot = 0;
+	}
+	return true;
+}
+
+const std::complex<double>* ComplexDemodulator::getOutput() const
+{
+	return output.data();
+}
+
+std::complex<double> ComplexDemodulator::getOscillator() const
+{
+	return oscillator;
+}
+
+int ComplexDemodulator::getNumChannels() const
+{
+	return nChannels;
+}
+
+int ComplexDemodulator::getWindowLength() const
+{
+	return windowLength;
+}
+
+double ComplexDemodulator::getDelay() const
+{
+	// two boxcars of windowLength samples
+	return windowLength - 1.0;
+}
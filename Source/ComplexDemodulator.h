@@ -0,0 +1,53 @@
+#ifndef COMPLEXDEMODULATOR_H
+#define COMPLEXDEMODULATOR_H
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+
+/*
+ * Complex demodulation of many channels at one band. Every channel is mixed
+ * down by a shared recursive oscillator at the band centre and low-passed by
+ * a second order CIC filter: two integrators at the input rate, two combs of
+ * windowLength samples at the output rate, decimated by `decimation`.
+ * The CIC runs in wrapping 64-bit fixed point, so the integrators never
+ * lose precision. The cost per sample and channel does not depend on the
+ * band width or the window length; the channel loops are contiguous and
+ * vectorize. Frames are interleaved, channel after channel.
+ */
+class ComplexDemodulator
+{
+public:
+	ComplexDemodulator();
+
+	// windowLength is rounded to a multiple of decimation
+	void setup(int nChannels, double sampleRate, double center, int windowLength, int decimation);
+	void reset();
+
+	// one sample of every channel; true when a new decimated output is ready
+	bool process(const float* frame);
+
+	// A/2 exp(j phase) per channel for a sinusoid of amplitude A at the centre,
+	// delayed by getDelay() samples
+	const std::complex<double>* getOutput() const;
+	// exp(j 2 pi center t), to turn the baseband phase into the band phase
+	std::complex<double> getOscillator() const;
+
+	int getNumChannels() const;
+	int getWindowLength() const;
+	double getDelay() const;
+
+private:
+	int nChannels;
+	int decimation, combDelay, windowLength;
+	int phaseCount, slot, renormCount;
+	double normalization;
+	std::complex<double> oscillator, step;
+
+	std::vector<uint64_t> integratorRe1, integratorRe2, integratorIm1, integratorIm2;
+	std::vector<uint64_t> combRe1, combRe2, combIm1, combIm2;	// [slot][channel]
+	std::vector<std::complex<double>> output;
+};
+
+#endif
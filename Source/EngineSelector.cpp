@@ -0,0 +1,153 @@
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+// reference band for timing: 64 bins, a band power read every 8 samples
+static const int CALIBRATION_NFFT = 1024;
+static const int CALIBRATION_FMIN = 100;
+static const int CALIBRATION_FMAX = 163;
+static const int CALIBRATION_HOP = 8;
+static const int CALIBRATION_SAMPLES = 4096;
+static const int CALIBRATION_RUNS = 3;
+
+// window shape: one bin at a quarter of the rate, impulse response over 3 windows
+static const int IMPULSE_NFFT = 256;
+
+
+/* EngineSelector */
+EngineSelector::EngineSelector()
+{
+	std::mt19937 generator(1);
+	std::normal_distribution<double> noise;
+	std::vector<double> input(CALIBRATION_SAMPLES);
+	for (double& v : input) {
+		v = noise(generator);
+	}
+	std::vector<double> power;
+
+	for (int type = SdftType::RECTANGLE; type < SdftType::SDFT_TYPES; type++) {
+		if (type == SdftType::AutoEngine) {
+			continue;
+		}
+		Profile& profile = profiles[type];
+
+		std::unique_ptr<RealtimeSDFT> engine = create((SdftType)type);
+		engine->configure(CALIBRATION_FMIN, CALIBRATION_FMAX, CALIBRATION_NFFT, CALIBRATION_NFFT);
+		engine->setHop(CALIBRATION_HOP);
+		double best = 1e30;
+		for (int run = 0; run < CALIBRATION_RUNS; run++) {
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < CALIBRATION_SAMPLES; i++) {
+				engine->addSample(input[i]);
+				if (i % CALIBRATION_HOP == 0) {
+					engine->getBandPowerList(power);
+				}
+			}
+			std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count() / CALIBRATION_SAMPLES);
+		}
+		profile.nsPerCost = best / estimateEngineCost((SdftType)type, CALIBRATION_FMIN, CALIBRATION_FMAX,
+			CALIBRATION_NFFT, CALIBRATION_NFFT, CALIBRATION_HOP);
+
+		engine = create((SdftType)type);
+		engine->configure(IMPULSE_NFFT / 4, IMPULSE_NFFT / 4, IMPULSE_NFFT, IMPULSE_NFFT);
+		engine->setHop(1);
+		double sum = 0, sumSquares = 0, moment = 0;
+		for (int age = 0; age < 3 * IMPULSE_NFFT; age++) {
+			engine->addSample(age == 0 ? 1.0 : 0.0);
+			double w = std::abs(engine->fftout[0]);
+			sum += w;
+			sumSquares += w * w;
+			moment += age * w;
+		}
+		profile.enbwBins = (sum > 0) ? IMPULSE_NFFT * sumSquares / (sum * sum) : 1.0;
+		profile.centroid = (sum > 0) ? moment / sum / IMPULSE_NFFT : 0.5;
+	}
+}
+
+const EngineSelector& EngineSelector::get()
+{
+	static const EngineSelector selector;
+	return selector;
+}
+
+std::unique_ptr<RealtimeSDFT> EngineSelector::create(SdftType type)
+{
+	switch (type) {
+	case SdftType::RECTANGLE:
+		return std::make_unique<RealtimeSDFT>();
+	case SdftType::EXP:
+		return std::make_unique<RealtimeExpSDFT>();
+	case SdftType::ZeroPaddingExp:
+		return std::make_unique<RealtimeZeroPaddingExpSDFT>();
+	case SdftType::MirrorExp:
+		return std::make_unique<RealtimeMirrorExpSDFT>();
+	case SdftType::HoppedSTFT:
+		return std::make_unique<RealtimeSTFT>();
+	case SdftType::ConstantQ:
+		return std::make_unique<RealtimeConstantQ>();
+	case SdftType::HilbertEnvelope:
+		return std::make_unique<RealtimeHilbert>();
+	case SdftType::ComplexDemod:
+		return std::make_unique<RealtimeDemodulator>();
+	case SdftType::MultiWindow:
+		return std::make_unique<RealtimeMultiWindowSDFT>();
+	default:
+		throw std::invalid_argument("Invalid choice");
+	}
+}
+
+const char* EngineSelector::getName(SdftType type)
+{
+	static const char* names[] = { "", "Rectangle", "Exp", "ZeroPaddingExp", "MirrorExp", "Hopped STFT", "Auto", "Constant-Q", "Hilbert", "Complex demodulation", "Multi-window" };
+	return (type >= SdftType::RECTANGLE && type < SdftType::SDFT_TYPES) ? names[type] : "";
+}
+
+double EngineSelector::costNs(SdftType type, int fmin, int fmax, int nfft, int sampleRate, int hop) const
+{
+	return profiles[type].nsPerCost * estimateEngineCost(type, fmin, fmax, nfft, sampleRate, hop);
+}
+
+double EngineSelector::resolutionHz(SdftType type, int nfft, int sampleRate) const
+{
+	return profiles[type].enbwBins * sampleRate / nfft;
+}
+
+double EngineSelector::latencyMs(SdftType type, int nfft, int sampleRate, int hop) const
+{
+	// engines that only update on a hop hold their output for (hop - 1) / 2 samples on average
+	double samples = profiles[type].centroid * nfft;
+	if (type == SdftType::HoppedSTFT || type == SdftType::ComplexDemod) {
+		samples += (hop - 1) / 2.0;
+	}
+	return 1000.0 * samples / sampleRate;
+}
+
+SdftType EngineSelector::select(int fmin, int fmax, int nfft, int sampleRate, int hop, double latencyBudget) const
+{
+	const double bandwidth = std::max(fmax - fmin, 1);
+	SdftType cheapest = SdftType::AutoEngine, fastest = SdftType::RECTANGLE;
+	double cheapestCost = 0, fastestLatency = 1e30;
+	for (int i = SdftType::RECTANGLE; i < SdftType::SDFT_TYPES; i++) {
+		SdftType type = (SdftType)i;
+		if (type == SdftType::AutoEngine || resolutionHz(type, nfft, sampleRate) > bandwidth) {
+			continue;
+		}
+		double latency = latencyMs(type, nfft, sampleRate, hop);
+		if (latency < fastestLatency) {
+			fastest = type;
+			fastestLatency = latency;
+		}
+		if (latencyBudget > 0 && latency > latencyBudget) {
+			continue;
+		}
+		double cost = costNs(type, fmin, fmax, nfft, sampleRate, hop);
+		if (cheapest == SdftType::AutoEngine || cost < cheapestCost) {
+			cheapest = type;
+			cheapestCost = cost;
+		}
+	}
+	return (cheapest != SdftType::AutoEngine) ? cheapest : fastest;
+}
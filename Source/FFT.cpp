@@ -0,0 +1,316 @@
+#include "FFT.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+/* ComplexFFT */
+ComplexFFT::ComplexFFT(int size) : size(0)
+{
+	setup(size);
+}
+
+static std::vector<int> factorize(int n)
+{
+	// radix 4 first, then 2, 3, 5, ... as in most mixed-radix FFTs
+	std::vector<int> factors;
+	int p = 4;
+	double limit = std::floor(std::sqrt((double)n));
+	do {
+		while (n % p) {
+			switch (p) {
+			case 4: p = 2; break;
+			case 2: p = 3; break;
+			default: p += 2; break;
+			}
+			if (p > limit) {
+				p = n;
+			}
+		}
+		n /= p;
+		factors.push_back(p);
+		factors.push_back(n);
+	} while (n > 1);
+	return factors;
+}
+
+void ComplexFFT::setup(int size)
+{
+	size = std::max(size, 1);
+	if (size == this->size) {
+		return;
+	}
+	this->size = size;
+	factors = factorize(size);
+	twiddles.resize(size);
+	for (int i = 0; i < size; i++) {
+		double phase = -2.0 * M_PI * i / size;
+		twiddles[i] = std::complex<double>(std::cos(phase), std::sin(phase));
+	}
+	int maxFactor = 0;
+	for (size_t i = 0; i < factors.size(); i += 2) {
+		maxFactor = std::max(maxFactor, factors[i]);
+	}
+	scratch.resize(maxFactor);
+}
+
+int ComplexFFT::getSize() const
+{
+	return size;
+}
+
+void ComplexFFT::forward(const std::complex<double>* in, std::complex<double>* out)
+{
+	if (size == 1) {
+		out[0] = in[0];
+		return;
+	}
+	work(out, in, 1, factors.data());
+}
+
+void ComplexFFT::work(std::complex<double>* out, const std::complex<double>* in, int stride, const int* factors)
+{
+	const int p = factors[0];
+	const int m = factors[1];
+	if (m == 1) {
+		for (int i = 0; i < p; i++) {
+			out[i] = in[i * stride];
+		}
+	}
+	else {
+		for (int i = 0; i < p; i++) {
+			work(out + i * m, in + i * stride, stride * p, factors + 2);
+		}
+	}
+
+	switch (p) {
+	case 2: butterfly2(out, stride, m); break;
+	case 3: butterfly3(out, stride, m); break;
+	case 4: butterfly4(out, stride, m); break;
+	default: butterflyGeneric(out, stride, m, p); break;
+	}
+}
+
+void ComplexFFT::butterfly2(std::complex<double>* out, int stride, int m)
+{
+	std::complex<double>* out2 = out + m;
+	for (int i = 0; i < m; i++) {
+		std::complex<double> t = out2[i] * twiddles[i * stride];
+		out2[i] = out[i] - t;
+		out[i] += t;
+	}
+}
+
+void ComplexFFT::butterfly3(std::complex<double>* out, int stride, int m)
+{
+	const double sin60 = twiddles[stride * m].imag();
+	for (int i = 0; i < m; i++) {
+		std::complex<double> s1 = out[i + m] * twiddles[i * stride];
+		std::complex<double> s2 = out[i + 2 * m] * twiddles[2 * i * stride];
+		std::complex<double> s3 = s1 + s2;
+		std::complex<double> s0 = (s1 - s2) * sin60;
+		std::complex<double> mid = out[i] - 0.5 * s3;
+		out[i] += s3;
+		out[i + m] = std::complex<double>(mid.real() - s0.imag(), mid.imag() + s0.real());
+		out[i + 2 * m] = std::complex<double>(mid.real() + s0.imag(), mid.imag() - s0.real());
+	}
+}
+
+void ComplexFFT::butterfly4(std::complex<double>* out, int stride, int m)
+{
+	for (int i = 0; i < m; i++) {
+		std::complex<double> s0 = out[i + m] * twiddles[i * stride];
+		std::complex<double> s1 = out[i + 2 * m] * twiddles[2 * i * stride];
+		std::complex<double> s2 = out[i + 3 * m] * twiddles[3 * i * stride];
+		std::complex<double> s5 = out[i] - s1;
+		std::complex<double> s3 = s0 + s2;
+		std::complex<double> s4 = s0 - s2;
+		out[i] += s1;
+		out[i + 2 * m] = out[i] - s3;
+		out[i] += s3;
+		out[i + m] = std::complex<double>(s5.real() + s4.imag(), s5.imag() - s4.real());
+		out[i + 3 * m] = std::complex<double>(s5.real() - s4.imag(), s5.imag() + s4.real());
+	}
+}
+
+void ComplexFFT::butterflyGeneric(std::complex<double>* out, int stride, int m, int p)
+{
+	for (int u = 0; u < m; u++) {
+		for (int q = 0; q < p; q++) {
+			scratch[q] = out[u + q * m];
+		}
+		for (int q1 = 0; q1 < p; q1++) {
+			const int k = u + q1 * m;
+			int twiddleIndex = 0;
+			std::complex<double> sum = scratch[0];
+			for (int q = 1; q < p; q++) {
+				twiddleIndex += stride * k;
+				twiddleIndex %= size;
+				sum += scratch[q] * twiddles[twiddleIndex];
+			}
+			out[k] = sum;
+		}
+	}
+}
+
+double ComplexFFT::estimateCost(int size)
+{
+	if (size <= 1) {
+		return 0;
+	}
+	// flops per butterfly: radix 2: 1 cmul + 2 cadd, radix 3: 2 cmul + 6 cadd,
+	// radix 4: 3 cmul + 8 cadd, generic p: p (p - 1) cmul + cadd
+	std::vector<int> factors = factorize(size);
+	double cost = 0;
+	for (size_t i = 0; i < factors.size(); i += 2) {
+		const int p = factors[i];
+		double perButterfly;
+		switch (p) {
+		case 2: perButterfly = 10; break;
+		case 3: perButterfly = 24; break;
+		case 4: perButterfly = 34; break;
+		default: perButterfly = 8.0 * p * (p - 1); break;
+		}
+		cost += (double)size / p * perButterfly;
+	}
+	return cost;
+}
+
+
+/* PrunedRealDFT */
+PrunedRealDFT::PrunedRealDFT() :
+	size(0), binLow(0), binHigh(-1), decimation(1), subSize(1), cost(0)
+{
+}
+
+double PrunedRealDFT::decimationCost(int size, int decimation, int nBins, int nResidues)
+{
+	const int subSize = size / decimation;
+	const int nFFT = (decimation + 1) / 2;
+	// pack + sub-FFTs + split of the needed residues + one complex MAC per bin and sub-sequence
+	return size + nFFT * ComplexFFT::estimateCost(subSize) +
+		decimation * nResidues * 8.0 + nBins * decimation * 8.0;
+}
+
+int PrunedRealDFT::bestDecimation(int size, int binLow, int binHigh, double* cost)
+{
+	const int nBins = binHigh - binLow + 1;
+	int best = size;
+	double bestCost = decimationCost(size, size, nBins, 1);
+	for (int p = 1; p < size; p++) {
+		if (size % p) {
+			continue;
+		}
+		const int nResidues = std::min(nBins, size / p);
+		double c = decimationCost(size, p, nBins, nResidues);
+		if (c < bestCost) {
+			bestCost = c;
+			best = p;
+		}
+	}
+	if (cost) {
+		*cost = bestCost;
+	}
+	return best;
+}
+
+double PrunedRealDFT::estimateCost(int size, int binLow, int binHigh)
+{
+	double cost = 0;
+	bestDecimation(std::max(size, 1), binLow, std::max(binHigh, binLow), &cost);
+	return cost;
+}
+
+void PrunedRealDFT::setup(int size, int binLow, int binHigh)
+{
+	size = std::max(size, 1);
+	binLow = std::min(std::max(binLow, 0), size - 1);
+	binHigh = std::min(std::max(binHigh, binLow), size - 1);
+	if (size == this->size && binLow == this->binLow && binHigh == this->binHigh) {
+		return;
+	}
+	this->size = size;
+	this->binLow = binLow;
+	this->binHigh = binHigh;
+
+	decimation = bestDecimation(size, binLow, binHigh, &cost);
+	subSize = size / decimation;
+	fft.setup(subSize);
+	twiddles = TwiddleCache::get(size);
+
+	const int nBins = binHigh - binLow + 1;
+	residues.resize(nBins);
+	residueValues.clear();
+	for (int k = binLow; k <= binHigh; k++) {
+		const int r = k % subSize;
+		auto it = std::find(residueValues.begin(), residueValues.end(), r);
+		residues[k - binLow] = (int)(it - residueValues.begin());
+		if (it == residueValues.end()) {
+			residueValues.push_back(r);
+		}
+	}
+
+	packed.assign(subSize, std::complex<double>(0));
+	spectrum.assign(subSize, std::complex<double>(0));
+	subSpectra.assign(decimation * residueValues.size(), std::complex<double>(0));
+}
+
+void PrunedRealDFT::transform(const double* in, std::complex<double>* out)
+{
+	const int M = subSize;
+	const int P = decimation;
+	const int nResidues = (int)residueValues.size();
+
+	// two real sub-sequences per complex FFT: z = a + j b
+	for (int p = 0; p < P; p += 2) {
+		const bool pair = (p + 1 < P);
+		for (int m = 0; m < M; m++) {
+			packed[m] = std::complex<double>(in[m * P + p], pair ? in[m * P + p + 1] : 0.0);
+		}
+		fft.forward(packed.data(), spectrum.data());
+
+		std::complex<double>* a = subSpectra.data() + p * nResidues;
+		std::complex<double>* b = a + nResidues;
+		for (int i = 0; i < nResidues; i++) {
+			const int r = residueValues[i];
+			const std::complex<double> z = spectrum[r];
+			const std::complex<double> zc = std::conj(spectrum[r == 0 ? 0 : M - r]);
+			a[i] = 0.5 * (z + zc);
+			if (pair) {
+				const std::complex<double> d = z - zc;	// B = d / 2j
+				b[i] = std::complex<double>(0.5 * d.imag(), -0.5 * d.real());
+			}
+		}
+	}
+
+	// X[k] = sum_p exp(-j 2 pi p k / N) F_p[k mod M]
+	const std::complex<double>* w = twiddles->data();
+	for (int k = binLow; k <= binHigh; k++) {
+		const int r = residues[k - binLow];
+		const std::complex<double>* f = subSpectra.data() + r;
+		std::complex<double> sum = 0;
+		int index = 0;
+		for (int p = 0; p < P; p++) {
+			sum += std::conj(w[index]) * f[p * nResidues];
+			index += k;
+			if (index >= size) {
+				index -= size;
+			}
+		}
+		out[k - binLow] = sum;
+	}
+}
+
+int PrunedRealDFT::getDecimation() const
+{
+	return decimation;
+}
+
+double PrunedRealDFT::getCost() const
+{
+	return cost;
+}
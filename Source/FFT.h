@@ -0,0 +1,79 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+
+/*
+ * Mixed-radix (4, 2, 3, 5, generic) complex FFT, forward direction,
+ * X[k] = sum x[n] exp(-j 2 pi k n / N), any N.
+ */
+class ComplexFFT
+{
+public:
+	ComplexFFT(int size = 1);
+
+	void setup(int size);
+	int getSize() const;
+
+	// out-of-place, in and out hold size values each
+	void forward(const std::complex<double>* in, std::complex<double>* out);
+
+	// estimated real flops for one transform of this size
+	static double estimateCost(int size);
+
+private:
+	void work(std::complex<double>* out, const std::complex<double>* in, int stride, const int* factors);
+	void butterfly2(std::complex<double>* out, int stride, int m);
+	void butterfly3(std::complex<double>* out, int stride, int m);
+	void butterfly4(std::complex<double>* out, int stride, int m);
+	void butterflyGeneric(std::complex<double>* out, int stride, int m, int p);
+
+	int size;
+	std::vector<int> factors;	// p0, m0, p1, m1, ...
+	std::vector<std::complex<double>> twiddles;
+	std::vector<std::complex<double>> scratch;
+};
+
+
+/*
+ * DFT of a real frame restricted to bins binLow..binHigh (transform
+ * decomposition): the frame is split into P decimated sub-sequences of
+ * length M = N / P, two real sub-sequences share one complex M-point FFT,
+ * and only the requested bins are recombined. P is chosen from the
+ * divisors of N by the cost model, from P = 1 (full FFT) to P = N (direct DFT).
+ */
+class PrunedRealDFT
+{
+public:
+	PrunedRealDFT();
+
+	void setup(int size, int binLow, int binHigh);
+
+	// out[k - binLow] for k = binLow..binHigh
+	void transform(const double* in, std::complex<double>* out);
+
+	int getDecimation() const;
+	double getCost() const;
+
+	// estimated real flops per transform with the best decimation
+	static double estimateCost(int size, int binLow, int binHigh);
+
+private:
+	static double decimationCost(int size, int decimation, int nBins, int nResidues);
+	static int bestDecimation(int size, int binLow, int binHigh, double* cost);
+
+	int size, binLow, binHigh;
+	int decimation, subSize;
+	double cost;
+	ComplexFFT fft;
+	std::shared_ptr<const std::vector<std::complex<double>>> twiddles;	// exp(+j 2 pi k / N)
+	std::vector<int> residues;		// k mod M of every requested bin, as an index into the sub-spectra
+	std::vector<int> residueValues;
+	std::vector<std::complex<double>> packed, spectrum;
+	std::vector<std::complex<double>> subSpectra;	// [p][residue]
+};
+
+#endif
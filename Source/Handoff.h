@@ -0,0 +1,83 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <atomic>
+#include <memory>
+
+
+/*
+ * Passes objects built on the message thread to the audio thread without
+ * locks. The message thread builds an item off to the side and posts it;
+ * the audio thread takes it at the start of a block, swaps its contents in
+ * and releases it. Items are only allocated and deleted on the message
+ * thread: post() and collect() delete what the audio thread released. An
+ * item posted before the audio thread took the previous one replaces it,
+ * and post() hands the previous one back. T needs a `T* releasedNext`
+ * member for the release list.
+ */
+template <class T>
+class Handoff
+{
+public:
+	Handoff() : pending(nullptr), released(nullptr) {}
+
+	~Handoff()
+	{
+		delete pending.exchange(nullptr);
+		collect();
+	}
+
+	// message thread
+	std::unique_ptr<T> post(std::unique_ptr<T> item)
+	{
+		collect();
+		return std::unique_ptr<T>(pending.exchange(item.release(), std::memory_order_acq_rel));
+	}
+
+	// takes back the item the audio thread has not taken yet, if any
+	std::unique_ptr<T> withdraw()
+	{
+		return std::unique_ptr<T>(pending.exchange(nullptr, std::memory_order_acquire));
+	}
+
+	void collect()
+	{
+		T* item = released.exchange(nullptr, std::memory_order_acquire);
+		while (item != nullptr) {
+			T* next = item->releasedNext;
+			delete item;
+			item = next;
+		}
+	}
+
+	// audio thread, or the message thread while the audio thread is stopped
+	bool hasPending() const
+	{
+		return pending.load(std::memory_order_relaxed) != nullptr;
+	}
+
+	T* take()
+	{
+		if (!hasPending()) {
+			return nullptr;
+		}
+		return pending.exchange(nullptr, std::memory_order_acquire);
+	}
+
+	void release(T* item)
+	{
+		if (item == nullptr) {
+			return;
+		}
+		item->releasedNext = released.load(std::memory_order_relaxed);
+		while (!released.compare_exchange_weak(item->releasedNext, item,
+			std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+
+private:
+	std::atomic<T*> pending;
+	std::atomic<T*> released;	// a stack: pushed by the audio thread, emptied at once by collect()
+};
+
+#endif
@@ -24,6 +24,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "OcsBurstDetectorEditor.h"
 
+static const int TTL_LINES = 256;	// a TTL event carries its line in a uint8
+
 
 OcsBurstDetector::OcsBurstDetector()
     : GenericProcessor("Ocs Burst Detector")
@@ -46,6 +48,8 @@ OcsBurstDetector::OcsBurstDetector()
     addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_bandpassfilter", "USE BandPass Filter", controllerPtr->get_use_bandpass_filter(), true);
     addFloatParameter(Parameter::GLOBAL_SCOPE, "low_cut", "Filter low cut", controllerPtr->getBandpassLow(), 0.1, 15000, 0.001, true);
     addFloatParameter(Parameter::GLOBAL_SCOPE, "high_cut", "Filter high cut", controllerPtr->getBandpassHigh(), 0.1, 15000, 0.001, true);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "bandpass_design", "Filter design (0: auto, 1: Butterworth, 2: Bessel, 3: resonator, 4: linear phase FIR, 5: minimum phase FIR)", controllerPtr->getBandpassDesign(), 0, 5, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "delay_budget", "Filter delay budget in ms at the detection band (0: none)", controllerPtr->getDelayBudget(), 0, 1000, 0.1, true);
 
     addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_minus_Average", "USE Minus Average", controllerPtr->get_use_minus_average(), true);
 
@@ -54,8 +58,28 @@ OcsBurstDetector::OcsBurstDetector()
 
     addIntParameter(Parameter::GLOBAL_SCOPE, "rfs", "rfs", controllerPtr->get_rfs(), 1, 44100, true);
 
-    addIntParameter(Parameter::GLOBAL_SCOPE, "sdft_window_type", "Type of SDFT Window to use", controllerPtr->getSdftType(), 1, 3, true);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "spatial_reference", "Spatial re-referencing (0: none, 1: CAR, 2: CMR)", SpatialReference::NO_REFERENCE, 0, 2, true);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "spatial_weights", "Virtual channel weights (',' per channel, ';' per output)", String(), true);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "adaptive_spatial", "Learn the detection channel weights online", false, true);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "vote_groups", "K-of-N channel vote groups ('k:c,c,...', ';' per group)", String(), true);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "coherence_pairs", "Channel pairs for coherence ('a-b', ',' per pair)", String(), true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "coherence_time", "Coherence averaging time constant in s", 1.0, 0.01, 60, 0.01, true);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "coherence_measure", "Coherence trigger measure (0: magnitude squared coherence, 1: phase locking value)", ChannelCoherence::COHERENCE, 0, 1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "coherence_threshold", "Coherence trigger threshold (0: no trigger)", 0.0, 0.0, 1.0, 0.001, true);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_pac", "Phase-amplitude coupling of the detection band phase", false, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "pac_low", "Low cut of the coupled amplitude band", 30.0, 0.1, 15000, 0.1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "pac_high", "High cut of the coupled amplitude band", 80.0, 0.1, 15000, 0.1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "pac_time", "Modulation index forgetting time constant in s", 10.0, 0.1, 600, 0.1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "pac_threshold", "Modulation index trigger threshold (0: no trigger)", 0.0, 0.0, 1.0, 0.0001, true);
+
+    addIntParameter(Parameter::GLOBAL_SCOPE, "sdft_window_type", "Type of SDFT Window to use (6: cheapest that fits the band and latency)", controllerPtr->getSdftType(), 1, 10, true);
     addFloatParameter(Parameter::GLOBAL_SCOPE, "sdft_window_size", "Window Size of SDFT", controllerPtr->getSdftWindowSize(), 0.1, 10, 0.001, true);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "sdft_hop", "Samples between band power evaluations", controllerPtr->getSdftHop(), 1, 1000, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "latency_budget", "SDFT latency budget in ms for the Auto window type (0: none)", controllerPtr->getLatencyBudget(), 0, 10000, 0.1, true);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_two_stage", "Raise alerts on a short window, confirm them on the SDFT window", controllerPtr->get_use_two_stage(), true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "alert_window_size", "Window size of the alert stage", controllerPtr->getAlertWindowSize(), 0.01, 10, 0.001, true);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_power_domain", "Threshold |X|^2 instead of |X|", controllerPtr->get_use_power_domain(), true);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_relative_power", "Band power relative to the window's broadband RMS", controllerPtr->get_use_relative_power(), true);
 
     // Outout Options
     addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_delay", "is delay enabled", controllerPtr->get_use_delay(), true);
@@ -63,9 +87,24 @@ OcsBurstDetector::OcsBurstDetector()
     addFloatParameter(Parameter::GLOBAL_SCOPE, "delay_max", "Delay Max Time", controllerPtr->getDelayMax(), 0, 10, 0.001, true);
 
     addFloatParameter(Parameter::GLOBAL_SCOPE, "duration_time", "Duration Time", controllerPtr->getDurTime(), 0.001, 10, 0.001, true);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "onset_detector", "Burst onset (0: Duration Time above the threshold, 1: CUSUM)", controllerPtr->getOnsetDetector(), 0, 1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "false_alarm_rate", "CUSUM false alarms per minute", controllerPtr->getFalseAlarmRate(), 0.001, 60, 0.001, true);
     addFloatParameter(Parameter::GLOBAL_SCOPE, "light_duration_time", "Light Duration Time", controllerPtr->getLightDur(), 0.001, 10, 0.001, true);
     addFloatParameter(Parameter::GLOBAL_SCOPE, "ignore_duration_time", "Ignore Duration Time", controllerPtr->getIgnoreDur(), 0.001, 10, 0.001, true);
 
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_band_ratio", "Only start crossings while the detection band to reference band power ratio is high", controllerPtr->get_use_band_ratio(), true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "ratio_low", "Reference band low cut", controllerPtr->getRatioLow(), 0.1, 15000, 0.001, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "ratio_high", "Reference band high cut", controllerPtr->getRatioHigh(), 0.1, 15000, 0.001, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "ratio_threshold", "Band power ratio that opens the gate", controllerPtr->getRatioThreshold(), 0, 1000, 0.001, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "ratio_window", "Band power ratio RMS window in s", controllerPtr->getRatioWindow(), 0.01, 60, 0.001, true);
+
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_artifact_gate", "Freeze detection during large-amplitude artifacts", useArtifactGate, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "artifact_amplitude", "Artifact absolute amplitude in uV (0: off)", 1000, 0, 100000, 1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "artifact_derivative", "Artifact slope in uV/ms (0: off)", 2000, 0, 100000, 1, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "artifact_saturation", "Amplifier saturation level in uV (0: off)", 0, 0, 100000, 1, true);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "artifact_channels", "Selected channels that must break a limit at once", 1, 1, 1024, true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "artifact_recovery", "Time in s detection stays frozen after an artifact", 0.5, 0, 60, 0.001, true);
+
     //// Parameter for manually generating events
     //addStringParameter(Parameter::GLOBAL_SCOPE, // parameter scope
     //    "manual_clear",        // parameter name
@@ -115,12 +154,48 @@ void OcsBurstDetector::updateSettings()
         eventChannels.add(new EventChannel(lightEventChannelPtrSettings));
         eventChannels.getLast()->addProcessor(processorInfo.get());
         lightEventChannelPtr = eventChannels.getLast();
+
+        EventChannel::Settings voteEventChannelPtrSettings{
+                EventChannel::Type::TTL,
+                "Ocs Burst Detector Output",
+                "vote EventChannel",
+                "ttl.events",
+                getDataStream(stream->getStreamId())
+        };
+        eventChannels.add(new EventChannel(voteEventChannelPtrSettings));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        voteEventChannelPtr = eventChannels.getLast();
+
+        EventChannel::Settings coherenceEventChannelPtrSettings{
+                EventChannel::Type::TTL,
+                "Ocs Burst Detector Output",
+                "coherence EventChannel",
+                "ttl.events",
+                getDataStream(stream->getStreamId())
+        };
+        eventChannels.add(new EventChannel(coherenceEventChannelPtrSettings));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        coherenceEventChannelPtr = eventChannels.getLast();
+
+        EventChannel::Settings pacEventChannelPtrSettings{
+                EventChannel::Type::TTL,
+                "Ocs Burst Detector Output",
+                "pac EventChannel",
+                "ttl.events",
+                getDataStream(stream->getStreamId())
+        };
+        eventChannels.add(new EventChannel(pacEventChannelPtrSettings));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        pacEventChannelPtr = eventChannels.getLast();
     }
 }
 
 
 void OcsBurstDetector::process(AudioBuffer<float>& buffer)
 {
+    if (channelStageUpdates.hasPending()) {
+        applyChannelStages();
+    }
     for (auto stream : getDataStreams())
     {
 
@@ -136,6 +211,23 @@ void OcsBurstDetector::process(AudioBuffer<float>& buffer)
 
             const float** ptrRs = buffer.getArrayOfReadPointers();
 
+            const bool adaptiveSpatial = useAdaptiveSpatial;
+            if (adaptiveSpatial) {
+                if (const std::vector<float>* weights = adaptiveSpatialFilter.fetchWeights()) {
+                    spatialFilter.setWeightRow(0, *weights);
+                }
+            }
+
+            // only the decimated samples reach the controller, so the spatial stage skips the rest
+            int firstSample = std::max(rfs_factor - 1 - rfs_idx, 0);
+            spatialFilter.process(ptrRs, firstSample, nSamples, std::max(rfs_factor, 1));
+            const float* virtualChannel = spatialFilter.getOutput(0);
+            const float* reference = spatialFilter.getReference();
+            int rfs_sample = 0;
+            if (useArtifactGate) {
+                artifactDetector.process(ptrRs, channelList, nSamples);
+            }
+
             for (int i = 0; i < nSamples; i++) {
                 rfs_idx++;
                 if (rfs_idx < rfs_factor) {
@@ -145,11 +237,67 @@ void OcsBurstDetector::process(AudioBuffer<float>& buffer)
                 }
                 rfs_idx = 0;
 
-                float avgInput = 0;
-                for (int j = 0; j < channelListLength; j++) {
-                    avgInput += ptrRs[channelList[j]][i];
+                // the hold covers at least one decimation step, so sample i stands for the ones skipped
+                bool gated = useArtifactGate && artifactDetector.isGated(i);
+                bool voting = !gated && channelVoting.getNumGroups() > 0;
+                bool coherence = !gated && channelCoherence.getNumPairs() > 0;
+                bool pac = !gated && usePac;
+                bool adaptive = !gated && adaptiveSpatial;
+                bool channelBand = voting || coherence || pac;
+                if (adaptive || channelBand) {
+                    for (int j = 0; j < (int)channelFrame.size(); j++) {
+                        channelFrame[j] = ptrRs[channelList[j]][i];
+                    }
+                }
+                if (adaptive && reference != nullptr) {
+                    // learned on the re-referenced channels, which the weights are applied to
+                    for (int j = 0; j < (int)channelFrame.size(); j++) {
+                        referencedFrame[j] = channelFrame[j] - reference[rfs_sample];
+                    }
+                    adaptiveSpatialFilter.addFrame(referencedFrame.data());
+                }
+                else if (adaptive) {
+                    adaptiveSpatialFilter.addFrame(channelFrame.data());
+                }
+                if (channelBand && channelVoting.process(channelFrame.data())) {
+                    for (int g = 0; g < std::min(channelVoting.getNumGroups(), TTL_LINES); g++) {
+                        if (channelVoting.hasGroupChanged(g)) {
+                            TTLEventPtr m_voteEventChannel_eventPtr = TTLEvent::createTTLEvent(voteEventChannelPtr,
+                                startSampleForBlock + i,
+                                g, channelVoting.isGroupOn(g));
+
+                            addEvent(m_voteEventChannel_eventPtr, i);
+                        }
+                    }
+                    if (coherence) {
+                        channelCoherence.addHop(channelVoting.getBins());
+                        for (int p = 0; p < std::min(channelCoherence.getNumPairs(), TTL_LINES); p++) {
+                            if (channelCoherence.hasPairChanged(p)) {
+                                TTLEventPtr m_coherenceEventChannel_eventPtr = TTLEvent::createTTLEvent(coherenceEventChannelPtr,
+                                    startSampleForBlock + i,
+                                    p, channelCoherence.isPairOn(p));
+
+                                addEvent(m_coherenceEventChannel_eventPtr, i);
+                            }
+                        }
+                    }
+                }
+                if (pac && phaseAmplitudeCoupling.process(channelFrame.data(), channelVoting.getBins(), channelVoting.getOscillator())) {
+                    for (int c = 0; c < std::min(phaseAmplitudeCoupling.getNumChannels(), TTL_LINES); c++) {
+                        if (phaseAmplitudeCoupling.hasChannelChanged(c)) {
+                            TTLEventPtr m_pacEventChannel_eventPtr = TTLEvent::createTTLEvent(pacEventChannelPtr,
+                                startSampleForBlock + i,
+                                c, phaseAmplitudeCoupling.isChannelOn(c));
+
+                            addEvent(m_pacEventChannel_eventPtr, i);
+                        }
+                    }
                 }
-                auto [res, power] = controllerPtr->process(avgInput/channelListLength);
+
+                // blanked: the artifact stays out of the filters and the band power windows
+                controllerPtr->setFrozen(gated);
+                float sample = virtualChannel[rfs_sample++];
+                auto [res, power] = controllerPtr->process(gated ? 0.0f : sample);
 
                 *ptrBuffer = power*100; // Should //
                 last_power = power*100; // Should //
@@ -181,9 +329,38 @@ void OcsBurstDetector::process(AudioBuffer<float>& buffer)
 
 void OcsBurstDetector::parameterValueChanged(Parameter* param) {
     std::string name = param->getName().toStdString();
-    if ((!param->getName().equalsIgnoreCase("Channels")) && 
+    if (name == "spatial_reference") {
+        // the learned weights belong to the old reference
+        adaptiveSpatialFilter.clear();
+        configureChannelStages();
+    }
+    else if (name == "spatial_weights") {
+        configureChannelStages();
+    }
+    else if (name == "adaptive_spatial") {
+        adaptiveSpatialFilter.clear();
+        configureChannelStages();
+    }
+    else if (name == "vote_groups") {
+        configureChannelStages();
+    }
+    else if (name == "coherence_pairs" || name == "coherence_time" || name == "coherence_measure" || name == "coherence_threshold") {
+        configureChannelStages();
+    }
+    else if (name == "use_pac" || name == "pac_low" || name == "pac_high" || name == "pac_time" || name == "pac_threshold") {
+        configureChannelStages();
+    }
+    else if (name == "use_artifact_gate" || name == "artifact_amplitude" || name == "artifact_derivative" ||
+        name == "artifact_saturation" || name == "artifact_channels" || name == "artifact_recovery") {
+        configureChannelStages();
+    }
+    else if ((!param->getName().equalsIgnoreCase("Channels")) && 
         (!param->getName().equalsIgnoreCase("enable_stream"))) {
         controllerPtr->parameterValueChange(name, param->getValue());
+        if (name == "freq_low" || name == "freq_high" || name == "rfs") {
+            adaptiveSpatialFilter.setBand(controllerPtr->getFreqLow(), controllerPtr->getFreqHigh(), controllerPtr->get_rfs());
+        }
+        configureChannelStages();
     }
 
     rfs_idx = 0;
@@ -194,23 +371,264 @@ void OcsBurstDetector::setSelectedStream(juce::uint16 streamId)
     selectedStreamId = streamId;
 }
 
+void OcsBurstDetector::configureChannelStages()
+{
+    // a change the audio thread has not taken yet is built again, with this one
+    if (std::unique_ptr<ChannelStageUpdate> withdrawn = channelStageUpdates.withdraw()) {
+        postedStages = withdrawn->from;
+    }
+    const ChannelStageSettings& posted = postedStages;
+    ChannelStageSettings s = posted;
+    int rfs = controllerPtr->get_rfs();
+    int hop = controllerPtr->getSdftHop();
+    s.nChannels = (int)channelList.size();
+    s.sampleRate = rfs;
+    s.fmin = controllerPtr->getFreqLow();
+    s.fmax = controllerPtr->getFreqHigh();
+    s.windowLength = std::max((int)(rfs * controllerPtr->getSdftWindowSize()), 1);
+    s.hop = hop;
+    // durations count hops, as in the controller
+    s.twindow = (int)((double)rfs / hop * controllerPtr->getDurTime());
+    s.powerDomain = controllerPtr->get_use_power_domain();
+    s.autoThreshold = controllerPtr->get_use_auto_th();
+    s.stdThreshold = controllerPtr->getStdTH();
+    s.threshold = controllerPtr->getThreshold();
+    s.groups = getParameter("vote_groups")->getValueAsString().toStdString();
+    s.pairs = getParameter("coherence_pairs")->getValueAsString().toStdString();
+    s.coherenceTime = (double)getParameter("coherence_time")->getValue();
+    s.coherenceThreshold = (double)getParameter("coherence_threshold")->getValue();
+    s.coherenceMeasure = (int)getParameter("coherence_measure")->getValue();
+    s.usePac = (bool)getParameter("use_pac")->getValue();
+    s.pacLow = (double)getParameter("pac_low")->getValue();
+    s.pacHigh = (double)getParameter("pac_high")->getValue();
+    s.phaseCenter = (s.fmin + s.fmax) / 2.0;
+    s.pacTime = (double)getParameter("pac_time")->getValue();
+    s.pacThreshold = (double)getParameter("pac_threshold")->getValue();
+    s.useArtifactGate = (bool)getParameter("use_artifact_gate")->getValue();
+    // the limits are in the units of the data, uV for the continuous channels
+    ArtifactDetector::Limits& limits = s.artifactLimits;
+    limits.sampleRate = controllerPtr->get_fs();
+    limits.amplitude = (double)getParameter("artifact_amplitude")->getValue();
+    limits.derivative = (double)getParameter("artifact_derivative")->getValue();
+    limits.saturation = (double)getParameter("artifact_saturation")->getValue();
+    limits.minChannels = (int)getParameter("artifact_channels")->getValue();
+    limits.recovery = (double)getParameter("artifact_recovery")->getValue();
+    limits.minHold = controllerPtr->get_rfs_factor();
+    s.channels = channelList;
+    s.spatialReference = (int)getParameter("spatial_reference")->getValue();
+    s.spatialWeights = getParameter("spatial_weights")->getValueAsString().toStdString();
+    s.adaptiveSpatial = (bool)getParameter("adaptive_spatial")->getValue();
+
+    auto u = std::make_unique<ChannelStageUpdate>();
+    u->from = posted;
+    bool changed = false;
+    int groups = 0;
+    // the band powers and their statistics only restart with the band, the window or their units
+    if (s.nChannels != posted.nChannels || s.sampleRate != posted.sampleRate || s.fmin != posted.fmin ||
+        s.fmax != posted.fmax || s.windowLength != posted.windowLength || s.hop != posted.hop ||
+        s.twindow != posted.twindow || s.powerDomain != posted.powerDomain) {
+        u->voting = std::make_unique<ChannelVoting>();
+        u->voting->setGroups(ChannelVoting::parseGroups(s.groups));
+        u->voting->setup(s.nChannels, s.sampleRate, s.fmin, s.fmax, s.windowLength, s.hop, s.twindow,
+            s.autoThreshold, s.stdThreshold, s.threshold, s.powerDomain);
+        groups = u->voting->getNumGroups();
+        changed = true;
+    }
+    else {
+        if (s.groups != posted.groups) {
+            u->newGroups = true;
+            ChannelVoting::setupGroups(u->groups, ChannelVoting::parseGroups(s.groups), s.nChannels);
+            groups = (int)u->groups.ks.size();
+            changed = true;
+        }
+        if (s.autoThreshold != posted.autoThreshold || s.stdThreshold != posted.stdThreshold ||
+            s.threshold != posted.threshold) {
+            u->newThreshold = true;
+            u->autoThreshold = s.autoThreshold;
+            u->stdThreshold = s.stdThreshold;
+            u->threshold = s.threshold;
+            changed = true;
+        }
+    }
+    if (groups > TTL_LINES) {
+        std::cout << "[Error] Only the first " << TTL_LINES << " of " << groups << " vote groups drive TTL lines" << std::endl;
+    }
+
+    // the running averages only restart with the pairs
+    double hopRate = (double)rfs / hop;
+    ChannelCoherence::Measure measure = static_cast<ChannelCoherence::Measure>(s.coherenceMeasure);
+    if (s.pairs != posted.pairs || s.nChannels != posted.nChannels) {
+        u->coherence = std::make_unique<ChannelCoherence>();
+        u->coherence->setPairs(ChannelCoherence::parsePairs(s.pairs), s.nChannels);
+        u->coherence->setup(hopRate, s.coherenceTime, measure, s.coherenceThreshold);
+        if (u->coherence->getNumPairs() > TTL_LINES) {
+            std::cout << "[Error] Only the first " << TTL_LINES << " of " << u->coherence->getNumPairs()
+                << " coherence pairs drive TTL lines" << std::endl;
+        }
+        changed = true;
+    }
+    else if (s.sampleRate != posted.sampleRate || s.hop != posted.hop || s.coherenceTime != posted.coherenceTime ||
+        s.coherenceMeasure != posted.coherenceMeasure || s.coherenceThreshold != posted.coherenceThreshold) {
+        u->newCoherenceSetup = true;
+        u->hopRate = hopRate;
+        u->coherenceTime = s.coherenceTime;
+        u->coherenceMeasure = measure;
+        u->coherenceThreshold = s.coherenceThreshold;
+        changed = true;
+    }
+
+    // the histograms only restart with the amplitude or phase band
+    if (s.nChannels != posted.nChannels || s.sampleRate != posted.sampleRate || s.hop != posted.hop ||
+        s.pacLow != posted.pacLow || s.pacHigh != posted.pacHigh || s.phaseCenter != posted.phaseCenter) {
+        u->pac = std::make_unique<PhaseAmplitudeCoupling>();
+        u->pac->setup(s.nChannels, s.sampleRate, s.pacLow, s.pacHigh, s.hop, s.phaseCenter, s.pacTime, s.pacThreshold);
+        changed = true;
+    }
+    else if (s.pacTime != posted.pacTime || s.pacThreshold != posted.pacThreshold) {
+        u->newPacTimeConstant = true;
+        u->pacTime = s.pacTime;
+        u->pacThreshold = s.pacThreshold;
+        changed = true;
+    }
+    if (s.usePac != posted.usePac) {
+        u->newUsePac = true;
+        u->usePac = s.usePac;
+        changed = true;
+    }
+    if (s.usePac && s.nChannels > TTL_LINES) {
+        std::cout << "[Error] Only the first " << TTL_LINES << " of " << s.nChannels << " channels drive PAC TTL lines" << std::endl;
+    }
+
+
+    // the derivative runs across blocks, so the last samples only restart with the channels
+    const ArtifactDetector::Limits& was = posted.artifactLimits;
+    bool limitsChanged = limits.sampleRate != was.sampleRate || limits.amplitude != was.amplitude ||
+        limits.derivative != was.derivative || limits.saturation != was.saturation ||
+        limits.minChannels != was.minChannels || limits.recovery != was.recovery || limits.minHold != was.minHold;
+    if (s.nChannels != posted.nChannels) {
+        u->artifact = std::make_unique<ArtifactDetector>();
+        u->artifact->setup(s.nChannels, limits);
+        changed = true;
+    }
+    else if (limitsChanged) {
+        u->newArtifactLimits = true;
+        u->artifactLimits = limits;
+        changed = true;
+    }
+    if (s.useArtifactGate != posted.useArtifactGate) {
+        u->newUseArtifactGate = true;
+        u->useArtifactGate = s.useArtifactGate;
+        changed = true;
+    }
+
+    // the weight matrix is only reallocated with the channels or the user weights, which
+    // wait while learned ones are in use and come back when learning is turned off
+    bool userWeights = !s.adaptiveSpatial && (s.spatialWeights != posted.spatialWeights || posted.adaptiveSpatial);
+    if (s.channels != posted.channels || userWeights) {
+        u->spatial = std::make_unique<SpatialFilter>();
+        u->spatial->setChannels(s.channels);
+        u->spatial->setReference(static_cast<SpatialReference>(s.spatialReference));
+        u->spatial->setWeights(SpatialFilter::parseWeights(s.spatialWeights));
+        changed = true;
+    }
+    else if (s.spatialReference != posted.spatialReference) {
+        u->newReference = true;
+        u->reference = static_cast<SpatialReference>(s.spatialReference);
+        changed = true;
+    }
+    if (s.adaptiveSpatial != posted.adaptiveSpatial) {
+        u->newAdaptiveSpatial = true;
+        u->adaptiveSpatial = s.adaptiveSpatial;
+        changed = true;
+    }
+
+    if (changed) {
+        postedStages = s;
+        channelStageUpdates.post(std::move(u));
+    }
+}
+
+void OcsBurstDetector::applyChannelStages()
+{
+    // audio thread, or the message thread while acquisition is stopped
+    ChannelStageUpdate* u = channelStageUpdates.take();
+    if (u == nullptr) {
+        return;
+    }
+    if (u->voting) {
+        std::swap(channelVoting, *u->voting);
+    }
+    if (u->newGroups) {
+        channelVoting.swapGroups(u->groups);
+    }
+    if (u->newThreshold) {
+        channelVoting.setThreshold(u->autoThreshold, u->stdThreshold, u->threshold);
+    }
+    if (u->coherence) {
+        std::swap(channelCoherence, *u->coherence);
+    }
+    if (u->newCoherenceSetup) {
+        channelCoherence.setup(u->hopRate, u->coherenceTime, u->coherenceMeasure, u->coherenceThreshold);
+    }
+    if (u->pac) {
+        std::swap(phaseAmplitudeCoupling, *u->pac);
+    }
+    if (u->newPacTimeConstant) {
+        phaseAmplitudeCoupling.setTimeConstant(u->pacTime, u->pacThreshold);
+    }
+    if (u->newUsePac) {
+        usePac = u->usePac;
+        phaseAmplitudeCoupling.clear();
+    }
+    if (u->artifact) {
+        std::swap(artifactDetector, *u->artifact);
+    }
+    if (u->newArtifactLimits) {
+        artifactDetector.setLimits(u->artifactLimits);
+    }
+    if (u->spatial) {
+        std::swap(spatialFilter, *u->spatial);
+    }
+    if (u->newReference) {
+        spatialFilter.setReference(u->reference);
+    }
+    if (u->newAdaptiveSpatial) {
+        useAdaptiveSpatial = u->adaptiveSpatial;
+    }
+    if (u->newUseArtifactGate) {
+        // a hold in the controller runs out on its own: the blanked samples are still in its windows
+        useArtifactGate = u->useArtifactGate;
+        artifactDetector.clear();
+    }
+    channelStageUpdates.release(u);
+}
+
 
 bool OcsBurstDetector::startAcquisition() {
     rfs_idx = 0;
     controllerPtr->clear_all();
 
-    channelListLength = 0;
+    channelList.clear();
     for (auto stream : getDataStreams())
     {
         if ((*stream)["enable_stream"])
         {
             for (auto localChannelIndex : *((*stream)["Channels"].getArray()))
             {
-                channelList[channelListLength] = int(localChannelIndex);
-                channelListLength++;
+                channelList.push_back(int(localChannelIndex));
             }
         }
     }
+    channelFrame.assign(channelList.size(), 0.0f);
+    referencedFrame.assign(channelList.size(), 0.0f);
+    adaptiveSpatialFilter.setChannels(channelList.size());
+    adaptiveSpatialFilter.setBand(controllerPtr->getFreqLow(), controllerPtr->getFreqHigh(), controllerPtr->get_rfs());
+    configureChannelStages();
+    applyChannelStages();
+    channelVoting.clear();
+    channelCoherence.clear();
+    phaseAmplitudeCoupling.clear();
+    artifactDetector.clear();
 
     std::cout << "[Start Acquisition]" << std::endl;
     std::cout << "FreqLow: " << controllerPtr->getFreqLow() << std::endl;
@@ -229,6 +647,9 @@ bool OcsBurstDetector::startAcquisition() {
     std::cout << "DurTime: " << controllerPtr->getDurTime() << std::endl;
     std::cout << "LightDur: " << controllerPtr->getLightDur() << std::endl;
     std::cout << "IgnoreDur: " << controllerPtr->getIgnoreDur() << std::endl;
+    std::cout << "RatioBand: " << controllerPtr->getRatioLow() << " - " << controllerPtr->getRatioHigh() << std::endl;
+    std::cout << "RatioThreshold: " << controllerPtr->getRatioThreshold() << std::endl;
+    std::cout << "RatioWindow: " << controllerPtr->getRatioWindow() << std::endl;
 
     std::cout << "UseDelay: " << std::boolalpha << controllerPtr->get_use_delay() << std::endl;
     std::cout << "UseSTFT: " << std::boolalpha << controllerPtr->get_use_stft() << std::endl;
@@ -236,16 +657,50 @@ bool OcsBurstDetector::startAcquisition() {
     std::cout << "UseMinusAverage: " << std::boolalpha << controllerPtr->get_use_minus_average() << std::endl;
     std::cout << "UseBandpassFilter: " << std::boolalpha << controllerPtr->get_use_bandpass_filter() << std::endl;
     std::cout << "UseSmooth: " << std::boolalpha << controllerPtr->get_use_smooth() << std::endl;
+    std::cout << "UseRelativePower: " << std::boolalpha << controllerPtr->get_use_relative_power() << std::endl;
+    std::cout << "UseBandRatio: " << std::boolalpha << controllerPtr->get_use_band_ratio() << std::endl;
 
     std::cout << "RFSFactor: " << controllerPtr->get_rfs_factor() << std::endl;
     std::cout << "FS: " << controllerPtr->get_fs() << std::endl;
     std::cout << "RFS: " << controllerPtr->get_rfs() << std::endl;
 
     std::cout << "Selected Channels : ";
-    for (int i = 0; i < channelListLength; i++) {
-        std::cout << channelList[i] << " ";
+    for (int channel : channelList) {
+        std::cout << channel << " ";
     }
     std::cout << std::endl;
+    std::cout << "Virtual Channels: " << spatialFilter.getNumOutputs() << std::endl;
+    std::cout << "AdaptiveSpatial: " << std::boolalpha << useAdaptiveSpatial << std::endl;
+    std::cout << "Vote Groups: " << channelVoting.getNumGroups() << std::endl;
+    std::cout << "Coherence Pairs: " << channelCoherence.getNumPairs() << std::endl;
+    std::cout << "PAC: " << std::boolalpha << usePac << std::endl;
+    std::cout << "ArtifactGate: " << std::boolalpha << useArtifactGate << std::endl;
+
+    return true;
+}
 
+bool OcsBurstDetector::stopAcquisition() {
+    if (controllerPtr->get_use_two_stage()) {
+        auto [raised, confirmed, cancelled, delay] = controllerPtr->getAlertStats();
+        std::cout << "[Stop Acquisition] alerts: " << raised << " raised, " << confirmed << " confirmed, "
+            << cancelled << " cancelled, confirmed after " << delay * 1000 << " ms on average" << std::endl;
+    }
+    if (controllerPtr->get_use_band_ratio()) {
+        std::cout << "[Stop Acquisition] band power ratio: " << controllerPtr->getBandRatio() << std::endl;
+    }
+    if (useArtifactGate) {
+        long long samples = std::max(artifactDetector.getSamples(), 1LL);
+        std::cout << "[Stop Acquisition] artifacts: " << artifactDetector.getArtifactCount() << ", detection frozen for "
+            << 100.0 * artifactDetector.getGatedSamples() / samples << "% of the samples" << std::endl;
+    }
+    for (int p = 0; p < channelCoherence.getNumPairs(); p++) {
+        const ChannelCoherence::Pair& pair = channelCoherence.getPair(p);
+        std::cout << "[Stop Acquisition] channels " << pair.a << "-" << pair.b << ": coherence " << channelCoherence.getCoherence(p)
+            << ", PLV " << channelCoherence.getPLV(p) << ", phase " << channelCoherence.getPhase(p) << " rad" << std::endl;
+    }
+    for (int c = 0; usePac && c < phaseAmplitudeCoupling.getNumChannels(); c++) {
+        std::cout << "[Stop Acquisition] channel " << c << ": modulation index " << phaseAmplitudeCoupling.getModulationIndex(c)
+            << ", preferred phase " << phaseAmplitudeCoupling.getPreferredPhase(c) << " rad" << std::endl;
+    }
     return true;
 }
\ No newline at end of file
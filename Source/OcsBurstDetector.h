@@ -25,7 +25,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <ProcessorHeaders.h>
 
+#include <atomic>
+
 #include "OcsController.h"
+#include "Handoff.h"
+#include "AdaptiveSpatialFilter.h"
+#include "ArtifactDetector.h"
+#include "ChannelCoherence.h"
+#include "ChannelVoting.h"
+#include "PhaseAmplitudeCoupling.h"
 
 class OcsBurstDetector : public GenericProcessor
 {
@@ -43,17 +51,27 @@ public:
 	void process(AudioBuffer<float>& buffer) override;
 
 	bool startAcquisition() override;
+	bool stopAcquisition() override;
 
 	void parameterValueChanged(Parameter* param) override;
 
 	void setSelectedStream(juce::uint16 streamId);
 
+	// per-channel band amplitudes for the vote groups, coherence pairs and
+	// phase-amplitude coupling, from the controller's settings, and the
+	// artifact gate; only a stage whose own settings changed is built again,
+	// and process() puts it in place
+	void configureChannelStages();
+
 	// void sendPowerEventTTL(int i, bool onset);
 	// void sendLightEventTTL(int i, bool onset);
 
 private:
 	EventChannel* thetaEventChannelPtr = nullptr;
 	EventChannel* lightEventChannelPtr = nullptr;
+	EventChannel* voteEventChannelPtr = nullptr;	// one TTL line per vote group
+	EventChannel* coherenceEventChannelPtr = nullptr;	// one TTL line per coherence pair
+	EventChannel* pacEventChannelPtr = nullptr;	// one TTL line per selected channel
 	int powerEventChannel = 0;
 	int lightEventChannel = 1;
 
@@ -62,8 +80,88 @@ private:
 	double last_power = 0;
 
 	juce::uint16 selectedStreamId;
-	int channelList[128];
-	int channelListLength = 0;
+	std::vector<int> channelList;
+
+	SpatialFilter spatialFilter;
+	AdaptiveSpatialFilter adaptiveSpatialFilter;
+	bool useAdaptiveSpatial = false;	// audio thread
+	std::vector<float> channelFrame;
+	std::vector<float> referencedFrame;	// what the learned weights are applied to
+
+	// what the channel stages run with, once process() took everything posted
+	struct ChannelStageSettings
+	{
+		int nChannels;	// -1: not configured yet
+		double sampleRate, fmin, fmax;
+		int windowLength, hop, twindow;
+		bool powerDomain, autoThreshold;
+		double stdThreshold, threshold;
+		std::string groups;
+
+		std::string pairs;
+		double coherenceTime, coherenceThreshold;
+		int coherenceMeasure;
+
+		bool usePac;
+		double pacLow, pacHigh, phaseCenter, pacTime, pacThreshold;
+
+		bool useArtifactGate;
+		ArtifactDetector::Limits artifactLimits;
+
+		std::vector<int> channels;
+		int spatialReference;
+		std::string spatialWeights;
+		bool adaptiveSpatial;
+	};
+
+	// channel stage changes built on the message thread and put in place by
+	// the audio thread at the start of a block, as for the controller
+	struct ChannelStageUpdate
+	{
+		ChannelStageSettings from;	// the settings it was built against
+
+		std::unique_ptr<ChannelVoting> voting;	// a new stage, from scratch
+		bool newGroups;
+		ChannelVoting::Groups groups;
+		bool newThreshold, autoThreshold;
+		double stdThreshold, threshold;
+
+		std::unique_ptr<ChannelCoherence> coherence;	// new pairs, from scratch
+		bool newCoherenceSetup;	// the averaging and trigger, keeping the averages
+		double hopRate, coherenceTime, coherenceThreshold;
+		ChannelCoherence::Measure coherenceMeasure;
+
+		std::unique_ptr<PhaseAmplitudeCoupling> pac;	// a new amplitude band, from scratch
+		bool newPacTimeConstant;	// keeping the histograms
+		double pacTime, pacThreshold;
+		bool newUsePac, usePac;	// turned on, the histograms restart
+
+		std::unique_ptr<ArtifactDetector> artifact;	// new channels, from scratch
+		bool newArtifactLimits;	// in place, keeping a running hold
+		ArtifactDetector::Limits artifactLimits;
+		bool newUseArtifactGate, useArtifactGate;	// the counts restart
+
+		std::unique_ptr<SpatialFilter> spatial;	// new channels or weights
+		bool newReference;	// in place
+		SpatialReference reference;
+		bool newAdaptiveSpatial, adaptiveSpatial;
+
+		ChannelStageUpdate* releasedNext;
+	};
+
+	void applyChannelStages();
+	Handoff<ChannelStageUpdate> channelStageUpdates;
+	ChannelStageSettings postedStages{ -1 };	// message thread
+
+	ChannelVoting channelVoting;
+	ChannelCoherence channelCoherence;
+	PhaseAmplitudeCoupling phaseAmplitudeCoupling;
+	bool usePac = false;	// audio thread
+
+	// full-rate artifact gate: gated samples reach no detection stage and
+	// freeze the controller
+	ArtifactDetector artifactDetector;
+	bool useArtifactGate = false;	// audio thread
 };
 
 #endif
\ No newline at end of file
@@ -158,6 +158,18 @@ void OcsBurstDetectorCanvas::comboBoxChanged(ComboBox* comboBoxThatHasChanged)
     if (comboBoxThatHasChanged == windowTypeSdftBox) {
         processor->getParameter("sdft_window_type")->setNextValue(windowTypeSdftBox->getSelectedId());
     }
+    else if (comboBoxThatHasChanged == bandpassDesignBox) {
+        processor->getParameter("bandpass_design")->setNextValue(bandpassDesignBox->getSelectedId() - 1);
+    }
+    else if (comboBoxThatHasChanged == onsetDetectorBox) {
+        int onset = onsetDetectorBox->getSelectedId() - 1;
+        processor->getParameter("onset_detector")->setNextValue(onset);
+        durationEditable->setEnabled(onset == OnsetDetector::COUNTER);
+        falseAlarmEditable->setEnabled(onset == OnsetDetector::CUSUM);
+    }
+    else if (comboBoxThatHasChanged == spatialReferenceBox) {
+        processor->getParameter("spatial_reference")->setNextValue(spatialReferenceBox->getSelectedId() - 1);
+    }
 }
 
 void OcsBurstDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
@@ -192,6 +204,13 @@ void OcsBurstDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
             processor->getParameter("high_cut")->setNextValue(newValFloat);
         }
     }
+    else if (labelThatHasChanged == delayBudgetEditable) {
+        prevValFloat = (float)processor->getParameter("delay_budget")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 1000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("delay_budget")->setNextValue(newValFloat);
+        }
+    }
     else if (labelThatHasChanged == smoothKEditable) {
         prevValFloat = (float)processor->getParameter("smooth_K")->getValue();
         if (updateFloatLabel(labelThatHasChanged, 0.001f, 1.0f, prevValFloat, &newValFloat))
@@ -206,6 +225,57 @@ void OcsBurstDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
             processor->getParameter("rfs")->setNextValue(newValInt);
         }
     }
+    else if (labelThatHasChanged == spatialWeightsEditable) {
+        processor->getParameter("spatial_weights")->setNextValue(spatialWeightsEditable->getText());
+    }
+    else if (labelThatHasChanged == voteGroupsEditable) {
+        processor->getParameter("vote_groups")->setNextValue(voteGroupsEditable->getText());
+    }
+    else if (labelThatHasChanged == coherencePairsEditable) {
+        processor->getParameter("coherence_pairs")->setNextValue(coherencePairsEditable->getText());
+    }
+    else if (labelThatHasChanged == coherenceTimeEditable) {
+        prevValFloat = (float)processor->getParameter("coherence_time")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.01f, 60.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("coherence_time")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == coherenceThresholdEditable) {
+        prevValFloat = (float)processor->getParameter("coherence_threshold")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 1.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("coherence_threshold")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == pacLowEditable) {
+        prevValFloat = (float)processor->getParameter("pac_low")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.1f, 15000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("pac_low")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == pacHighEditable) {
+        prevValFloat = (float)processor->getParameter("pac_high")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.1f, 15000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("pac_high")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == pacTimeEditable) {
+        prevValFloat = (float)processor->getParameter("pac_time")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.1f, 600.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("pac_time")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == pacThresholdEditable) {
+        prevValFloat = (float)processor->getParameter("pac_threshold")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 1.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("pac_threshold")->setNextValue(newValFloat);
+        }
+    }
     else if (labelThatHasChanged == windowSizeSdftEditable) {
         prevValFloat = (float)processor->getParameter("sdft_window_size")->getValue();
         if (updateFloatLabel(labelThatHasChanged, 0.1f, 10.0f, prevValFloat, &newValFloat))
@@ -213,6 +283,27 @@ void OcsBurstDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
             processor->getParameter("sdft_window_size")->setNextValue(newValFloat);
         }
     }
+    else if (labelThatHasChanged == hopSdftEditable) {
+        prevValInt = (int)processor->getParameter("sdft_hop")->getValue();
+        if (updateIntLabel(labelThatHasChanged, 1, 1000, prevValInt, &newValInt))
+        {
+            processor->getParameter("sdft_hop")->setNextValue(newValInt);
+        }
+    }
+    else if (labelThatHasChanged == alertWindowEditable) {
+        prevValFloat = (float)processor->getParameter("alert_window_size")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.01f, 10.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("alert_window_size")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == latencyBudgetEditable) {
+        prevValFloat = (float)processor->getParameter("latency_budget")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 10000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("latency_budget")->setNextValue(newValFloat);
+        }
+    }
     else if (labelThatHasChanged == minDelayEditable) {
         prevValFloat = (float)processor->getParameter("delay_min")->getValue();
         if (updateFloatLabel(labelThatHasChanged, 0.0f, 10.0f, prevValFloat, &newValFloat))
@@ -234,6 +325,13 @@ void OcsBurstDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
             processor->getParameter("duration_time")->setNextValue(newValFloat);
         }
     }
+    else if (labelThatHasChanged == falseAlarmEditable) {
+        prevValFloat = (float)processor->getParameter("false_alarm_rate")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.001f, 60.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("false_alarm_rate")->setNextValue(newValFloat);
+        }
+    }
     else if (labelThatHasChanged == lightDurEditable) {
         prevValFloat = (float)processor->getParameter("light_duration_time")->getValue();
         if (updateFloatLabel(labelThatHasChanged, 0.001f, 10.0f, prevValFloat, &newValFloat))
@@ -248,6 +346,69 @@ void OcsBurstDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
             processor->getParameter("ignore_duration_time")->setNextValue(newValFloat);
         }
     }
+    else if (labelThatHasChanged == ratioLowEditable) {
+        prevValFloat = (float)processor->getParameter("ratio_low")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.1f, 15000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("ratio_low")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == ratioHighEditable) {
+        prevValFloat = (float)processor->getParameter("ratio_high")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.1f, 15000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("ratio_high")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == ratioThresholdEditable) {
+        prevValFloat = (float)processor->getParameter("ratio_threshold")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 1000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("ratio_threshold")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == ratioWindowEditable) {
+        prevValFloat = (float)processor->getParameter("ratio_window")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.01f, 60.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("ratio_window")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == artifactAmplitudeEditable) {
+        prevValFloat = (float)processor->getParameter("artifact_amplitude")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 100000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("artifact_amplitude")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == artifactDerivativeEditable) {
+        prevValFloat = (float)processor->getParameter("artifact_derivative")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 100000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("artifact_derivative")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == artifactSaturationEditable) {
+        prevValFloat = (float)processor->getParameter("artifact_saturation")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 100000.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("artifact_saturation")->setNextValue(newValFloat);
+        }
+    }
+    else if (labelThatHasChanged == artifactChannelsEditable) {
+        prevValInt = (int)processor->getParameter("artifact_channels")->getValue();
+        if (updateIntLabel(labelThatHasChanged, 1, 1024, prevValInt, &newValInt))
+        {
+            processor->getParameter("artifact_channels")->setNextValue(newValInt);
+        }
+    }
+    else if (labelThatHasChanged == artifactRecoveryEditable) {
+        prevValFloat = (float)processor->getParameter("artifact_recovery")->getValue();
+        if (updateFloatLabel(labelThatHasChanged, 0.0f, 60.0f, prevValFloat, &newValFloat))
+        {
+            processor->getParameter("artifact_recovery")->setNextValue(newValFloat);
+        }
+    }
 }
 
 void OcsBurstDetectorCanvas::buttonClicked(Button* button)
@@ -270,6 +431,8 @@ void OcsBurstDetectorCanvas::buttonClicked(Button* button)
     else if (button == bandpassButton) {
         lowCutBandpassEditable->setEnabled(on);
         highCutBandpassEditable->setEnabled(on);
+        bandpassDesignBox->setEnabled(on);
+        delayBudgetEditable->setEnabled(on);
         processor->getParameter("use_bandpassfilter")->setNextValue(on);
     }
     else if (button == minusAverageButton) {
@@ -279,6 +442,28 @@ void OcsBurstDetectorCanvas::buttonClicked(Button* button)
         smoothKEditable->setEnabled(on);
         processor->getParameter("use_smooth")->setNextValue(on);
     }
+    else if (button == bandRatioButton) {
+        processor->getParameter("use_band_ratio")->setNextValue(on);
+    }
+    else if (button == artifactGateButton) {
+        processor->getParameter("use_artifact_gate")->setNextValue(on);
+    }
+    else if (button == pacButton) {
+        processor->getParameter("use_pac")->setNextValue(pacButton->getToggleState());
+    }
+    else if (button == coherencePlvButton) {
+        processor->getParameter("coherence_measure")->setNextValue(coherencePlvButton->getToggleState() ? 1 : 0);
+    }
+    else if (button == powerDomainButton) {
+        processor->getParameter("use_power_domain")->setNextValue(on);
+    }
+    else if (button == relativePowerButton) {
+        processor->getParameter("use_relative_power")->setNextValue(on);
+    }
+    else if (button == twoStageButton) {
+        alertWindowEditable->setEnabled(on);
+        processor->getParameter("use_two_stage")->setNextValue(on);
+    }
     else if (button == delayButton) {
         minDelayEditable->setEnabled(on);
         maxDelayEditable->setEnabled(on);
@@ -440,6 +625,41 @@ void OcsBurstDetectorCanvas::initializeOptionsPanel()
 
     thresholdGroupSet->addGroup({ bandpassButton, lowCutBandpassLabel, lowCutBandpassEditable,
     highCutBandpassLabel, highCutBandpassEditable });
+
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+
+    bandpassDesignLabel = new Label("bandpassDesignL", "Design: ");
+    bandpassDesignLabel->setBounds(bounds = { xPos, yPos, 90, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(bandpassDesignLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    bandpassDesignBox = new ComboBox("bandpassDesignSelection");
+    bandpassDesignBox->setBounds(bounds = { xPos += 90, yPos, 160, C_TEXT_HT });
+    bandpassDesignBox->addListener(this);
+    bandpassDesignBox->addItem("Auto (delay budget)", BandpassDesign::AUTO_BANDPASS + 1);
+    bandpassDesignBox->addItem("Butterworth", BandpassDesign::BUTTERWORTH + 1);
+    bandpassDesignBox->addItem("Bessel", BandpassDesign::BESSEL + 1);
+    bandpassDesignBox->addItem("Resonator", BandpassDesign::RESONATOR + 1);
+    bandpassDesignBox->addItem("Linear phase FIR", BandpassDesign::LINEAR_FIR + 1);
+    bandpassDesignBox->addItem("Minimum phase FIR", BandpassDesign::MINIMUM_FIR + 1);
+    bandpassDesignBox->setSelectedId((int)processor->getParameter("bandpass_design")->getValue() + 1, dontSendNotification);
+    bandpassDesignBox->setEnabled(bandpassButton->getToggleState());
+    optionsPanel->addAndMakeVisible(bandpassDesignBox);
+    opBounds = opBounds.getUnion(bounds);
+
+    delayBudgetLabel = new Label("delayBudgetL", "Delay Budget (ms):");
+    delayBudgetLabel->setBounds(bounds = { xPos += 180, yPos, 140, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(delayBudgetLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    delayBudgetEditable = createEditable("delayBudgetE", String((float)processor->getParameter("delay_budget")->getValue()),
+        "Maximum group delay at the detection band (0: no budget)", bounds = { xPos += 140, yPos, 50, C_TEXT_HT });
+    delayBudgetEditable->setEnabled(bandpassButton->getToggleState());
+    optionsPanel->addAndMakeVisible(delayBudgetEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({ bandpassDesignLabel, bandpassDesignBox, delayBudgetLabel, delayBudgetEditable });
     
     /* -------- Minus Average --------- */
     xPos = LEFT_EDGE + TAB_WIDTH;
@@ -488,6 +708,146 @@ void OcsBurstDetectorCanvas::initializeOptionsPanel()
     
     thresholdGroupSet->addGroup({ rfsLabel, rfsEditable });
 
+    /* -------- spatial --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    spatialLabel = new Label("spatial", "Reference: ");
+    spatialLabel->setBounds(bounds = { xPos, yPos, 90, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(spatialLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    spatialReferenceBox = new ComboBox("spatialReferenceSelection");
+    spatialReferenceBox->setBounds(bounds = { xPos += 90, yPos, 100, C_TEXT_HT });
+    spatialReferenceBox->addListener(this);
+    spatialReferenceBox->addItem("None", SpatialReference::NO_REFERENCE + 1);
+    spatialReferenceBox->addItem("CAR", SpatialReference::CAR + 1);
+    spatialReferenceBox->addItem("CMR", SpatialReference::CMR + 1);
+    spatialReferenceBox->setSelectedId((int)processor->getParameter("spatial_reference")->getValue() + 1, dontSendNotification);
+    optionsPanel->addAndMakeVisible(spatialReferenceBox);
+    opBounds = opBounds.getUnion(bounds);
+
+    spatialWeightsLabel = new Label("spatialWeightsL", "Weights: ");
+    spatialWeightsLabel->setBounds(bounds = { xPos += 120, yPos, 80, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(spatialWeightsLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    spatialWeightsEditable = createEditable("spatialWeightsE", processor->getParameter("spatial_weights")->getValueAsString(),
+        "Virtual channel weights, ',' between channels and ';' between outputs (empty: channel mean)",
+        bounds = { xPos += 80, yPos, 200, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(spatialWeightsEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    voteGroupsLabel = new Label("voteGroupsL", "Votes: ");
+    voteGroupsLabel->setBounds(bounds = { xPos += 210, yPos, 60, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(voteGroupsLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    voteGroupsEditable = createEditable("voteGroupsE", processor->getParameter("vote_groups")->getValueAsString(),
+        "K-of-N vote groups over the selected channels, 'k:c,c,...' with ';' between groups (empty: no voting)",
+        bounds = { xPos += 60, yPos, 160, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(voteGroupsEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({ spatialLabel, spatialReferenceBox, spatialWeightsLabel, spatialWeightsEditable, voteGroupsLabel, voteGroupsEditable });
+
+    /* -------- coherence --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    coherencePairsLabel = new Label("coherencePairsL", "Coherence: ");
+    coherencePairsLabel->setBounds(bounds = { xPos, yPos, 90, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(coherencePairsLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    coherencePairsEditable = createEditable("coherencePairsE", processor->getParameter("coherence_pairs")->getValueAsString(),
+        "Channel pairs over the selected channels, 'a-b' with ',' between pairs (empty: no coherence)",
+        bounds = { xPos += 90, yPos, 200, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(coherencePairsEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    coherenceTimeLabel = new Label("coherenceTimeL", "Time (s): ");
+    coherenceTimeLabel->setBounds(bounds = { xPos += 210, yPos, 80, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(coherenceTimeLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    coherenceTimeEditable = createEditable("coherenceTimeE", String((float)processor->getParameter("coherence_time")->getValue()),
+        "Averaging time constant of the cross-spectra",
+        bounds = { xPos += 80, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(coherenceTimeEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    coherencePlvButton = new ToggleButton("PLV");
+    coherencePlvButton->setBounds(bounds = { xPos += 60, yPos, 60, C_TEXT_HT });
+    coherencePlvButton->setToggleState((int)processor->getParameter("coherence_measure")->getValue() == ChannelCoherence::PLV, dontSendNotification);
+    coherencePlvButton->addListener(this);
+    optionsPanel->addAndMakeVisible(coherencePlvButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    coherenceThresholdLabel = new Label("coherenceThresholdL", "Trigger: ");
+    coherenceThresholdLabel->setBounds(bounds = { xPos += 70, yPos, 70, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(coherenceThresholdLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    coherenceThresholdEditable = createEditable("coherenceThresholdE", String((float)processor->getParameter("coherence_threshold")->getValue()),
+        "Pair TTL turns on above this coherence (PLV when toggled); 0: no trigger",
+        bounds = { xPos += 70, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(coherenceThresholdEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({ coherencePairsLabel, coherencePairsEditable, coherenceTimeLabel, coherenceTimeEditable,
+        coherencePlvButton, coherenceThresholdLabel, coherenceThresholdEditable });
+
+    /* -------- phase-amplitude coupling --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    pacButton = new ToggleButton("PAC, Amplitude (Hz): ");
+    pacButton->setBounds(bounds = { xPos, yPos, 170, C_TEXT_HT });
+    pacButton->setToggleState((bool)processor->getParameter("use_pac")->getValue(), dontSendNotification);
+    pacButton->addListener(this);
+    optionsPanel->addAndMakeVisible(pacButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacLowEditable = createEditable("pacLowE", String((float)processor->getParameter("pac_low")->getValue()),
+        "Low cut of the amplitude band; the phase is the detection band's",
+        bounds = { xPos += 170, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacLowEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacHighLabel = new Label("pacHighL", "-");
+    pacHighLabel->setBounds(bounds = { xPos += 50, yPos, 20, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacHighLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacHighEditable = createEditable("pacHighE", String((float)processor->getParameter("pac_high")->getValue()),
+        "High cut of the amplitude band",
+        bounds = { xPos += 20, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacHighEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacTimeLabel = new Label("pacTimeL", "Time (s): ");
+    pacTimeLabel->setBounds(bounds = { xPos += 60, yPos, 80, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacTimeLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacTimeEditable = createEditable("pacTimeE", String((float)processor->getParameter("pac_time")->getValue()),
+        "Forgetting time constant of the phase-binned amplitudes",
+        bounds = { xPos += 80, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacTimeEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacThresholdLabel = new Label("pacThresholdL", "Trigger: ");
+    pacThresholdLabel->setBounds(bounds = { xPos += 60, yPos, 70, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacThresholdLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    pacThresholdEditable = createEditable("pacThresholdE", String((float)processor->getParameter("pac_threshold")->getValue()),
+        "Channel TTL turns on above this modulation index; 0: no trigger",
+        bounds = { xPos += 70, yPos, 60, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(pacThresholdEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({ pacButton, pacLowEditable, pacHighLabel, pacHighEditable, pacTimeLabel, pacTimeEditable,
+        pacThresholdLabel, pacThresholdEditable });
+
     /* -------- sdft --------- */
     xPos = LEFT_EDGE + TAB_WIDTH;
     yPos += 40;
@@ -507,6 +867,13 @@ void OcsBurstDetectorCanvas::initializeOptionsPanel()
     windowTypeSdftBox->addItem("Rectangle", SdftType::RECTANGLE);
     windowTypeSdftBox->addItem("Exp", SdftType::EXP);
     windowTypeSdftBox->addItem("ZeroPaddingExp", SdftType::ZeroPaddingExp);
+    windowTypeSdftBox->addItem("MirrorExp", SdftType::MirrorExp);
+    windowTypeSdftBox->addItem("Hopped STFT", SdftType::HoppedSTFT);
+    windowTypeSdftBox->addItem("Constant-Q", SdftType::ConstantQ);
+    windowTypeSdftBox->addItem("Hilbert envelope", SdftType::HilbertEnvelope);
+    windowTypeSdftBox->addItem("Complex demodulation", SdftType::ComplexDemod);
+    windowTypeSdftBox->addItem("Multi-window", SdftType::MultiWindow);
+    windowTypeSdftBox->addItem("Auto (cheapest)", SdftType::AutoEngine);
     windowTypeSdftBox->setSelectedId((int)processor->getParameter("sdft_window_type")->getValue(), dontSendNotification);
     optionsPanel->addAndMakeVisible(windowTypeSdftBox);
     opBounds = opBounds.getUnion(bounds);
@@ -524,6 +891,71 @@ void OcsBurstDetectorCanvas::initializeOptionsPanel()
     thresholdGroupSet->addGroup({ sdftLabel, windowTypeSdftLabel, windowTypeSdftBox, 
         windowSizeSdftLabel, windowSizeSdftEditable});
 
+    /* -------- hop / power domain --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    hopSdftLabel = new Label("hopSdftL", "Hop (samples): ");
+    hopSdftLabel->setBounds(bounds = { xPos, yPos, 120, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(hopSdftLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    hopSdftEditable = createEditable("hopSdftE", String((int)processor->getParameter("sdft_hop")->getValue()),
+        "Band power, smoothing, statistics and thresholds run every this many samples",
+        bounds = { xPos += 120, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(hopSdftEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    powerDomainButton = new ToggleButton("Power |X|^2");
+    powerDomainButton->setBounds(bounds = { xPos += 80, yPos, 120, C_TEXT_HT });
+    powerDomainButton->setToggleState((bool)processor->getParameter("use_power_domain")->getValue(), dontSendNotification);
+    powerDomainButton->addListener(this);
+    optionsPanel->addAndMakeVisible(powerDomainButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    relativePowerButton = new ToggleButton("Relative");
+    relativePowerButton->setBounds(bounds = { xPos += 130, yPos, 90, C_TEXT_HT });
+    relativePowerButton->setToggleState((bool)processor->getParameter("use_relative_power")->getValue(), dontSendNotification);
+    relativePowerButton->addListener(this);
+    optionsPanel->addAndMakeVisible(relativePowerButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    latencyBudgetLabel = new Label("latencyBudgetL", "Auto latency (ms): ");
+    latencyBudgetLabel->setBounds(bounds = { xPos += 100, yPos, 140, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(latencyBudgetLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    latencyBudgetEditable = createEditable("latencyBudgetE", String((float)processor->getParameter("latency_budget")->getValue()),
+        "Latency budget of the Auto window type (0: none)",
+        bounds = { xPos += 140, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(latencyBudgetEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({ hopSdftLabel, hopSdftEditable, powerDomainButton, relativePowerButton, latencyBudgetLabel, latencyBudgetEditable });
+
+    /* -------- two-stage detection --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    twoStageButton = new ToggleButton("Two-stage");
+    twoStageButton->setBounds(bounds = { xPos, yPos, 120, C_TEXT_HT });
+    twoStageButton->setToggleState((bool)processor->getParameter("use_two_stage")->getValue(), dontSendNotification);
+    twoStageButton->addListener(this);
+    optionsPanel->addAndMakeVisible(twoStageButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    alertWindowLabel = new Label("alertWindowL", "Alert window (s): ");
+    alertWindowLabel->setBounds(bounds = { xPos += 120, yPos, 140, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(alertWindowLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    alertWindowEditable = createEditable("alertWindowE", String((float)processor->getParameter("alert_window_size")->getValue()),
+        "Short window that raises the alert; the SDFT window size confirms it",
+        bounds = { xPos += 140, yPos, 50, C_TEXT_HT });
+    alertWindowEditable->setEnabled(twoStageButton->getToggleState());
+    optionsPanel->addAndMakeVisible(alertWindowEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({ twoStageButton, alertWindowLabel, alertWindowEditable });
+
 
     /* ****************  Output Options  **************** */
     outputGroupSet = new VerticalGroupSet("Output options");
@@ -586,7 +1018,137 @@ void OcsBurstDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(durationEditable);
     opBounds = opBounds.getUnion(bounds);
 
-    outputGroupSet->addGroup({ durationLabel, durationEditable });
+    onsetDetectorBox = new ComboBox("onsetDetectorSelection");
+    onsetDetectorBox->setBounds(bounds = { xPos += 70, yPos, 120, C_TEXT_HT });
+    onsetDetectorBox->addListener(this);
+    onsetDetectorBox->addItem("Duration", OnsetDetector::COUNTER + 1);
+    onsetDetectorBox->addItem("CUSUM", OnsetDetector::CUSUM + 1);
+    onsetDetectorBox->setSelectedId((int)processor->getParameter("onset_detector")->getValue() + 1, dontSendNotification);
+    optionsPanel->addAndMakeVisible(onsetDetectorBox);
+    opBounds = opBounds.getUnion(bounds);
+
+    falseAlarmLabel = new Label("falseAlarmL", "False alarms / min:");
+    falseAlarmLabel->setBounds(bounds = { xPos += 130, yPos, 140, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(falseAlarmLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    falseAlarmEditable = createEditable("falseAlarmE", String((float)processor->getParameter("false_alarm_rate")->getValue()),
+        "CUSUM false alarm rate over all bands", bounds = { xPos += 140, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(falseAlarmEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    bool cusumOnset = (onsetDetectorBox->getSelectedId() - 1 == OnsetDetector::CUSUM);
+    durationEditable->setEnabled(!cusumOnset);
+    falseAlarmEditable->setEnabled(cusumOnset);
+
+    outputGroupSet->addGroup({ durationLabel, durationEditable, onsetDetectorBox, falseAlarmLabel, falseAlarmEditable });
+
+    /* -------- band-ratio gate --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    bandRatioButton = new ToggleButton("Ratio gate, Reference (Hz): ");
+    bandRatioButton->setBounds(bounds = { xPos, yPos, 210, C_TEXT_HT });
+    bandRatioButton->setToggleState((bool)processor->getParameter("use_band_ratio")->getValue(), dontSendNotification);
+    bandRatioButton->addListener(this);
+    optionsPanel->addAndMakeVisible(bandRatioButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioLowEditable = createEditable("ratioLowE", String((float)processor->getParameter("ratio_low")->getValue()),
+        "Low cut of the reference band, e.g. delta", bounds = { xPos += 210, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioLowEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioHighLabel = new Label("ratioHighL", "-");
+    ratioHighLabel->setBounds(bounds = { xPos += 50, yPos, 20, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioHighLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioHighEditable = createEditable("ratioHighE", String((float)processor->getParameter("ratio_high")->getValue()),
+        "High cut of the reference band", bounds = { xPos += 20, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioHighEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioThresholdLabel = new Label("ratioThresholdL", "Ratio >= ");
+    ratioThresholdLabel->setBounds(bounds = { xPos += 60, yPos, 70, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioThresholdLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioThresholdEditable = createEditable("ratioThresholdE", String((float)processor->getParameter("ratio_threshold")->getValue()),
+        "Detection band over reference band power needed to start a crossing", bounds = { xPos += 70, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioThresholdEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioWindowLabel = new Label("ratioWindowL", "Window (s): ");
+    ratioWindowLabel->setBounds(bounds = { xPos += 60, yPos, 90, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioWindowLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    ratioWindowEditable = createEditable("ratioWindowE", String((float)processor->getParameter("ratio_window")->getValue()),
+        "RMS window of both bands", bounds = { xPos += 90, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(ratioWindowEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    outputGroupSet->addGroup({ bandRatioButton, ratioLowEditable, ratioHighLabel, ratioHighEditable,
+        ratioThresholdLabel, ratioThresholdEditable, ratioWindowLabel, ratioWindowEditable });
+
+    /* -------- artifact gate --------- */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+    artifactGateButton = new ToggleButton("Artifact gate, |x| (uV) > ");
+    artifactGateButton->setBounds(bounds = { xPos, yPos, 210, C_TEXT_HT });
+    artifactGateButton->setToggleState((bool)processor->getParameter("use_artifact_gate")->getValue(), dontSendNotification);
+    artifactGateButton->addListener(this);
+    optionsPanel->addAndMakeVisible(artifactGateButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactAmplitudeEditable = createEditable("artifactAmplitudeE", String((float)processor->getParameter("artifact_amplitude")->getValue()),
+        "Absolute amplitude of an artifact (0: off)", bounds = { xPos += 210, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactAmplitudeEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactDerivativeLabel = new Label("artifactDerivativeL", "|dx/dt| (uV/ms) > ");
+    artifactDerivativeLabel->setBounds(bounds = { xPos += 60, yPos, 130, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactDerivativeLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactDerivativeEditable = createEditable("artifactDerivativeE", String((float)processor->getParameter("artifact_derivative")->getValue()),
+        "Sample to sample slope of an artifact (0: off)", bounds = { xPos += 130, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactDerivativeEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactSaturationLabel = new Label("artifactSaturationL", "Saturation: ");
+    artifactSaturationLabel->setBounds(bounds = { xPos += 60, yPos, 90, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactSaturationLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactSaturationEditable = createEditable("artifactSaturationE", String((float)processor->getParameter("artifact_saturation")->getValue()),
+        "Amplifier rail in uV (0: off)", bounds = { xPos += 90, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactSaturationEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactChannelsLabel = new Label("artifactChannelsL", "Channels: ");
+    artifactChannelsLabel->setBounds(bounds = { xPos += 60, yPos, 80, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactChannelsLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactChannelsEditable = createEditable("artifactChannelsE", String((int)processor->getParameter("artifact_channels")->getValue()),
+        "Selected channels that must break a limit at once", bounds = { xPos += 80, yPos, 40, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactChannelsEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactRecoveryLabel = new Label("artifactRecoveryL", "Recovery (s): ");
+    artifactRecoveryLabel->setBounds(bounds = { xPos += 50, yPos, 100, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactRecoveryLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    artifactRecoveryEditable = createEditable("artifactRecoveryE", String((float)processor->getParameter("artifact_recovery")->getValue()),
+        "Detection stays frozen this long after the last artifact sample", bounds = { xPos += 100, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(artifactRecoveryEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    outputGroupSet->addGroup({ artifactGateButton, artifactAmplitudeEditable, artifactDerivativeLabel, artifactDerivativeEditable,
+        artifactSaturationLabel, artifactSaturationEditable, artifactChannelsLabel, artifactChannelsEditable,
+        artifactRecoveryLabel, artifactRecoveryEditable });
 
     /* -------- light duration --------- */
     xPos = LEFT_EDGE + TAB_WIDTH;
@@ -96,6 +96,10 @@ private:
     ScopedPointer<Label> lowCutBandpassEditable;
     ScopedPointer<Label> highCutBandpassLabel;
     ScopedPointer<Label> highCutBandpassEditable;
+    ScopedPointer<Label> bandpassDesignLabel;
+    ScopedPointer<ComboBox> bandpassDesignBox;
+    ScopedPointer<Label> delayBudgetLabel;
+    ScopedPointer<Label> delayBudgetEditable;
 
     // minus average
     ScopedPointer<ToggleButton> minusAverageButton;
@@ -108,12 +112,48 @@ private:
     ScopedPointer<Label> rfsLabel;
     ScopedPointer<Label> rfsEditable;
 
+    // spatial
+    ScopedPointer<Label> spatialLabel;
+    ScopedPointer<ComboBox> spatialReferenceBox;
+    ScopedPointer<Label> spatialWeightsLabel;
+    ScopedPointer<Label> spatialWeightsEditable;
+    ScopedPointer<Label> voteGroupsLabel;
+    ScopedPointer<Label> voteGroupsEditable;
+
+    // coherence
+    ScopedPointer<Label> coherencePairsLabel;
+    ScopedPointer<Label> coherencePairsEditable;
+    ScopedPointer<Label> coherenceTimeLabel;
+    ScopedPointer<Label> coherenceTimeEditable;
+    ScopedPointer<ToggleButton> coherencePlvButton;
+    ScopedPointer<Label> coherenceThresholdLabel;
+    ScopedPointer<Label> coherenceThresholdEditable;
+
+    // phase-amplitude coupling
+    ScopedPointer<ToggleButton> pacButton;
+    ScopedPointer<Label> pacLowEditable;
+    ScopedPointer<Label> pacHighLabel;
+    ScopedPointer<Label> pacHighEditable;
+    ScopedPointer<Label> pacTimeLabel;
+    ScopedPointer<Label> pacTimeEditable;
+    ScopedPointer<Label> pacThresholdLabel;
+    ScopedPointer<Label> pacThresholdEditable;
+
     // sdft
     ScopedPointer<Label> sdftLabel;
     ScopedPointer<Label> windowTypeSdftLabel;
     ScopedPointer<ComboBox> windowTypeSdftBox;
     ScopedPointer<Label> windowSizeSdftLabel;
     ScopedPointer<Label> windowSizeSdftEditable;
+    ScopedPointer<Label> hopSdftLabel;
+    ScopedPointer<Label> hopSdftEditable;
+    ScopedPointer<ToggleButton> powerDomainButton;
+    ScopedPointer<ToggleButton> relativePowerButton;
+    ScopedPointer<Label> latencyBudgetLabel;
+    ScopedPointer<Label> latencyBudgetEditable;
+    ScopedPointer<ToggleButton> twoStageButton;
+    ScopedPointer<Label> alertWindowLabel;
+    ScopedPointer<Label> alertWindowEditable;
 
 
     /****** output section ******/
@@ -130,6 +170,31 @@ private:
     // duration time
     ScopedPointer<Label> durationLabel;
     ScopedPointer<Label> durationEditable;
+    ScopedPointer<ComboBox> onsetDetectorBox;
+    ScopedPointer<Label> falseAlarmLabel;
+    ScopedPointer<Label> falseAlarmEditable;
+
+    // band-ratio gate
+    ScopedPointer<ToggleButton> bandRatioButton;
+    ScopedPointer<Label> ratioLowEditable;
+    ScopedPointer<Label> ratioHighLabel;
+    ScopedPointer<Label> ratioHighEditable;
+    ScopedPointer<Label> ratioThresholdLabel;
+    ScopedPointer<Label> ratioThresholdEditable;
+    ScopedPointer<Label> ratioWindowLabel;
+    ScopedPointer<Label> ratioWindowEditable;
+
+    // artifact gate
+    ScopedPointer<ToggleButton> artifactGateButton;
+    ScopedPointer<Label> artifactAmplitudeEditable;
+    ScopedPointer<Label> artifactDerivativeLabel;
+    ScopedPointer<Label> artifactDerivativeEditable;
+    ScopedPointer<Label> artifactSaturationLabel;
+    ScopedPointer<Label> artifactSaturationEditable;
+    ScopedPointer<Label> artifactChannelsLabel;
+    ScopedPointer<Label> artifactChannelsEditable;
+    ScopedPointer<Label> artifactRecoveryLabel;
+    ScopedPointer<Label> artifactRecoveryEditable;
 
     // light duration
     ScopedPointer<Label> lightDurLabel;
@@ -1,45 +1,108 @@
 #include "OcsController.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static const int HISTORY_WINDOWS = 4;	// windows of preprocessed samples kept for warm starts
+static const int CONFIRM_WAIT = 4;	// alerts are looked at a quarter of the long window after they are raised
+static const double RELATIVE_FLOOR = 1e-12;	// window RMS of a silent input
+static const int SETTLE_DELAYS = 3;	// group delays at the detection band for the prefilter to stop ringing
+static const auto WARM_POLL = std::chrono::milliseconds(5);	// the worker's wait for a wakeup it missed
+
+
+// band power over the RMS of the window it came from
+static void toRelativePower(std::vector<double>& power, double rms, bool powerDomain)
+{
+    const double r = std::max(rms, RELATIVE_FLOOR);
+    const double scale = powerDomain ? 1.0 / (r * r) : 1.0 / r;
+    for (double& p : power) {
+        p *= scale;
+    }
+}
 
 
 OcsController::OcsController() :
-    freqLow(8),
+    processFunctions{ nullptr, nullptr },
+    historyIndex(0),
+    historyCount(0),
+    posted(),
+    active(),
+    bandpassDelay(0),
+    warmExiting(false),
+    warmInFlight(false),
+    warmJob(nullptr),
+    warmDone(nullptr),
     freqHigh(12),
-    fix_threshold(0.5),
-    isDelayEnabled(false),
-    USE_STFT(true),
+    freqLow(8),
     USE_Auto_TH(true),
+    threshold(0.5),
+    fix_threshold(0.5),
+    STD_TH(2),
     USE_Bandpassfilter(true),
-    USE_Smooth(false),
     bandpassLow(0.6),
     bandpassHigh(150),
-    sdft_type(SdftType::ZeroPaddingExp),
-    sdft_window_size(1),
-    STD_TH(2),
+    bandpass_design(BandpassDesign::BUTTERWORTH),
+    delay_budget(0),
     USE_Minus_Average(true),
+    USE_Smooth(false),
     smooth_theta_k(0.9),
+    USE_STFT(true),
+    sdft_type(SdftType::ZeroPaddingExp),
+    sdft_window_size(1),
+    sdft_hop(1),
+    hopCount(0),
+    latency_budget(0),
+    USE_Power_Domain(false),
+    USE_Relative_Power(false),
+    isDelayEnabled(false),
+    delayMin(0.5),
+    delayMax(1.0),
+    bandpass(std::make_unique<BandpassFilter>()),
     fs(30000),
     rfs(300),
+    USE_Band_Ratio(false),
+    ratio_low(1),
+    ratio_high(4),
+    ratio_threshold(1),
+    ratio_window(2),
+    ratioThetaBandpass(std::make_unique<BandpassFilter>()),
+    ratioRefBandpass(std::make_unique<BandpassFilter>()),
+    RMS_nsamp(1000),
+    bandRatio(0),
+    frozenLeft(0),
+    sdft(nullptr),
+    SDFT_nfft(300),
+    USE_Two_Stage(false),
+    alert_window_size(0.1),
+    baselineCount(0),
     twindow(0.08),
+    onset_detector(OnsetDetector::COUNTER),
+    false_alarm_rate(1.0),
     lightDur(0.2),
     ignoreDur(0.5),
     holdDur(0.2),
     clearDur(2),
-    delayMin(0.5),
-    delayMax(1.0),
     random_seed(72),
-    RMS_nsamp(1000),
-    SDFT_nfft(300),
-    threshold(0.5),
     tmplightOn(false),
     tmpthetaCrossingOn(false),
-    tsBuffer (0),
-    sdft(nullptr)
+    tsBuffer (0)
 {
+    warmWorker = std::thread(&OcsController::warmStartLoop, this);
     init();
+    applyPending();
 }
 
 OcsController::~OcsController()
 {
+    {
+        std::lock_guard<std::mutex> lock(warmMutex);
+        warmExiting = true;
+    }
+    warmCv.notify_all();
+    if (warmWorker.joinable()) {
+        warmWorker.join();
+    }
+    delete warmDone.exchange(nullptr);
 }
 
 
@@ -69,6 +132,12 @@ void OcsController::parameterValueChange(std::string name, double value) {
     else if (name == "high_cut") {
         bandpassHigh = value;
     }
+    else if (name == "bandpass_design") {
+        bandpass_design = static_cast<BandpassDesign>(static_cast<int>(value));
+    }
+    else if (name == "delay_budget") {
+        delay_budget = value;
+    }
     else if (name == "use_minus_Average") {
         USE_Minus_Average = (value > 0.5);
     }
@@ -87,6 +156,24 @@ void OcsController::parameterValueChange(std::string name, double value) {
     else if (name == "sdft_window_size") {
         SDFT_nfft = (int)(rfs * value);
     }
+    else if (name == "sdft_hop") {
+        sdft_hop = std::max((int)value, 1);
+    }
+    else if (name == "use_two_stage") {
+        USE_Two_Stage = (value > 0.5);
+    }
+    else if (name == "alert_window_size") {
+        alert_window_size = value;
+    }
+    else if (name == "latency_budget") {
+        latency_budget = value;
+    }
+    else if (name == "use_power_domain") {
+        USE_Power_Domain = (value > 0.5);
+    }
+    else if (name == "use_relative_power") {
+        USE_Relative_Power = (value > 0.5);
+    }
     else if (name == "use_delay") {
         isDelayEnabled = (value > 0.5);
     }
@@ -99,44 +186,124 @@ void OcsController::parameterValueChange(std::string name, double value) {
     else if (name == "duration_time") {
         twindow = value;
     }
+    else if (name == "onset_detector") {
+        onset_detector = static_cast<OnsetDetector>(static_cast<int>(value));
+    }
+    else if (name == "false_alarm_rate") {
+        false_alarm_rate = value;
+    }
     else if (name == "light_duration_time") {
         lightDur = value;
     }
     else if (name == "ignore_duration_time") {
         ignoreDur = value;
     }
+    else if (name == "use_band_ratio") {
+        USE_Band_Ratio = (value > 0.5);
+    }
+    else if (name == "ratio_low") {
+        ratio_low = value;
+    }
+    else if (name == "ratio_high") {
+        ratio_high = value;
+    }
+    else if (name == "ratio_threshold") {
+        ratio_threshold = value;
+    }
+    else if (name == "ratio_window") {
+        ratio_window = value;
+    }
     else {
         std::cout << "[Error] UnKnow Param: " << name << "    " << value << std::endl;
     }
     init();
 }
 
-// int OcsController::process(int nSamples, const float ptrT)
+inline void OcsController::pushHistory(float sample)
+{
+    history[historyIndex] = sample;
+    if (++historyIndex == (int)history.size()) {
+        historyIndex = 0;
+    }
+    historyCount++;
+}
+
 std::tuple<int, double> OcsController::process(float sample)
 {
-    // auto [theta, ref] = monitor.checkHold(tsBuffer, ptrT, ptrR);
-    if (USE_Bandpassfilter) {
-        sample = bandpass.filter(sample);
+    if (reconfigurations.hasPending() || warmDone.load(std::memory_order_relaxed) != nullptr) {
+        applyPending();
     }
+    return (this->*processFunctions[frozenLeft > 0])(sample);
+}
 
-    if (USE_Minus_Average) {
+template <class Engine, bool Bandpass, bool MinusAverage, bool SmoothPower, bool AutoThreshold, bool TwoStage,
+    bool RatioGate, bool Relative, bool Frozen>
+std::tuple<int, double> OcsController::processSpecialized(float sample)
+{
+    if constexpr (RatioGate) {
+        ratioStage(sample);
+    }
+    if constexpr (Bandpass) {
+        sample = bandpass->filter(sample);
+    }
+
+    pushHistory(sample);
+    if constexpr (MinusAverage) {
         sample = slidingWindow.addSample(sample);
     }
 
-    sdft->addSample(sample);
-    std::vector<double> power = sdft->getBandPowerList();
+    // qualified call: no virtual dispatch once the engine type is known
+    Engine* engine = static_cast<Engine*>(sdft.get());
+    engine->Engine::addSample(sample);
+    if constexpr (Relative) {
+        rms_total.addSample(sample);
+    }
+    if constexpr (TwoStage) {
+        // only the ring write, the transform waits for an alert
+        confirmSdft->RealtimeSTFT::addSample(sample);
+    }
+    if (++hopCount < active.hop) {
+        // between hops only the state bits are reported, transitions happen on a hop
+        int res = (tmpthetaCrossingOn ? 0b0100 : 0) | (tmplightOn ? 0b0001 : 0);
+        return std::make_tuple(res, power[0]);
+    }
+    hopCount = 0;
+    engine->getBandPowerList(power);
+    if constexpr (Relative) {
+        toRelativePower(power, rms_total.getRes(), active.usePowerDomain);
+    }
 
-    if (USE_Smooth) {
+    if constexpr (Frozen) {
+        auto [lightOn, thetaCrossingOn, is_over] = switchController.freeze(tsBuffer);
+        int res = 0;
+        if (tmplightOn ^ lightOn) res |= 0b0010;
+        if (thetaCrossingOn) res |= 0b0100;
+        if (lightOn) res |= 0b0001;
+        tmplightOn = lightOn;
+        tsBuffer++;
+        return std::make_tuple(res, power[0]);
+    }
+
+    if constexpr (SmoothPower) {
         smooth_power.addSamples(power);
-        power = smooth_power.getRes();
+        smooth_power.getRes(power);
     }
 
-    if (USE_Auto_TH) {
+    if constexpr (AutoThreshold) {
         std_power.addSamples(power);
-        switchController.setTH(std_power.getResN(STD_TH));
+        std_power.getResN(active.stdTH, autoThresholds);
+        switchController.setTH(autoThresholds);
+    }
+    if constexpr (RatioGate) {
+        updateRatioGate();
     }
     auto [lightOn, thetaCrossingOn, is_over] = \
         switchController.checkTH(power, tsBuffer, sample);
+    if constexpr (TwoStage) {
+        // a cancelled alert switches the light off
+        confirmStage();
+        lightOn = switchController.isLightOn;
+    }
     int res = 0;
     if (tmpthetaCrossingOn ^ thetaCrossingOn) res |= 0b1000;
     if (thetaCrossingOn) res |= 0b0100;
@@ -149,46 +316,102 @@ std::tuple<int, double> OcsController::process(float sample)
     return std::make_tuple(res, power[0]);
 }
 
+template <class Engine, bool Relative, size_t... Flags>
+OcsController::ProcessFunction OcsController::selectProcessFunction(int flags, std::index_sequence<Flags...>)
+{
+    static const ProcessFunction table[] = {
+        // frozen (64) has no smoothing (4) or statistics (8)
+        &OcsController::processSpecialized<Engine, (Flags & 1) != 0, (Flags & 2) != 0, (Flags & 68) == 4, (Flags & 72) == 8,
+            (Flags & 16) != 0, (Flags & 32) != 0, Relative, (Flags & 64) != 0>...
+    };
+    return table[flags];
+}
+
 std::vector<double> OcsController::process2(float sample)
 {
-    std::vector<double> res(21, 0);
+    if (reconfigurations.hasPending() || warmDone.load(std::memory_order_relaxed) != nullptr) {
+        applyPending();
+    }
+    // sized by the engine: the multi-window engine reports every band once per window
     int n = sdft->get_n();
+    const int smoothed = 3 + n, thresholds = 3 + 2 * n, flags = 3 + 3 * n;
+    std::vector<double> res(flags + 3, 0);
     res[0] = sample;
+    if (active.ratioGate) {
+        ratioStage(sample);
+    }
     
-    if (USE_Bandpassfilter) {
-        sample = bandpass.filter(sample);
+    if (active.useBandpass) {
+        sample = bandpass->filter(sample);
     }
     res[1] = sample;
+    pushHistory(sample);
 
-    if (USE_Minus_Average) {
+    if (active.useMinusAverage) {
         sample = slidingWindow.addSample(sample);
     }
     res[2] = sample;
 
     sdft->addSample(sample);
-    std::vector<double> power = sdft->getBandPowerList();
+    if (active.useRelativePower) {
+        rms_total.addSample(sample);
+    }
+    if (active.twoStage) {
+        confirmSdft->addSample(sample);
+    }
+    if (++hopCount < active.hop) {
+        for (int i = 0; i < n; i++)
+            res[i + 3] = res[i + smoothed] = power[i];
+        res[flags] = tmplightOn;
+        res[flags + 1] = tmpthetaCrossingOn;
+        return res;
+    }
+    hopCount = 0;
+    sdft->getBandPowerList(power);
+    if (active.useRelativePower) {
+        toRelativePower(power, rms_total.getRes(), active.usePowerDomain);
+    }
     for (int i = 0; i < n; i++)
         res[i + 3] = power[i];
 
-    if (USE_Smooth) {
+    if (frozenLeft > 0) {
+        auto [lightOn, thetaCrossingOn, is_over] = switchController.freeze(tsBuffer);
+        for (int i = 0; i < n; i++)
+            res[i + smoothed] = power[i];
+        res[flags] = tmplightOn = lightOn;
+        res[flags + 1] = thetaCrossingOn;
+        tsBuffer++;
+        return res;
+    }
+
+    if (active.useSmooth) {
         smooth_power.addSamples(power);
-        power = smooth_power.getRes();
+        smooth_power.getRes(power);
     }
     for (int i = 0; i < n; i++)
-        res[i + 8] = power[i];
+        res[i + smoothed] = power[i];
 
-    if (USE_Auto_TH) {
+    if (active.useAutoTH) {
         std_power.addSamples(power);
-        switchController.setTH(std_power.getResN(STD_TH));
+        switchController.setTH(std_power.getResN(active.stdTH));
     }
+    std::vector<double> stdThresholds = std_power.getResN(active.stdTH);
     for (int i = 0; i < n; i++)
-        res[i + 13] = std_power.getResN(STD_TH)[i];
+        res[i + thresholds] = stdThresholds[i];
 
+    if (active.ratioGate) {
+        updateRatioGate();
+    }
     auto [lightOn, thetaCrossingOn, is_over] = \
         switchController.checkTH(power, tsBuffer, sample);
-    res[18] = lightOn;
-    res[19] = thetaCrossingOn;
-    res[20] = is_over;
+    if (active.twoStage) {
+        // a cancelled alert switches the light off
+        confirmStage();
+        lightOn = switchController.isLightOn;
+    }
+    res[flags] = lightOn;
+    res[flags + 1] = thetaCrossingOn;
+    res[flags + 2] = is_over;
 
     tmplightOn = lightOn;
     tmpthetaCrossingOn = thetaCrossingOn;
@@ -198,77 +421,513 @@ std::vector<double> OcsController::process2(float sample)
 
 void OcsController::clear_all()
 {
+    // the audio thread is stopped: whatever is still in flight or posted goes in now
+    waitWarmIdle();
+    historyIndex = 0;
+    historyCount = 0;
+    applyPending();
+
     tsBuffer = 0;
+    hopCount = 0;
+    frozenLeft = 0;
     tmplightOn = false;
     tmpthetaCrossingOn = false;
 
     std_power.clear();
     smooth_power.clear(); 
-    bandpass.reset();
+    bandpass->reset();
     slidingWindow.clear();
 	sdft->clear();
 	switchController.clear(tsBuffer);
+    if (confirmSdft) {
+        confirmSdft->clear();
+    }
+    confirmStd.clear();
+    baselineCount = 0;
+    rms_total.clear();
+    ratioThetaBandpass->reset();
+    ratioRefBandpass->reset();
+    rms_theta.clear();
+    rms_ref.clear();
+    bandRatio = 0;
 }
 
 void OcsController::init()
 {
-    switchController.twindow = twindow;
-    switchController.lightDur = lightDur;
-    switchController.ignoreDur = ignoreDur;
-    switchController.holdDur = holdDur;
-    switchController.clearDur = clearDur;
-    switchController.random_seed = random_seed;
-    switchController.random_delay.first = delayMin;
-    switchController.random_delay.second = delayMax;
-    switchController.isDelayEnabled = isDelayEnabled;
-    switchController.sampleRate = fs;
-    switchController.rfs = rfs;
+    // a configuration the audio thread has not taken yet is built again, with this change
+    if (std::unique_ptr<Reconfiguration> withdrawn = reconfigurations.withdraw()) {
+        posted = withdrawn->from;
+    }
+    auto r = std::make_unique<Reconfiguration>();
+    r->from = posted;
+    Settings& s = r->settings;
+    s = posted;
 
-    threshold = fix_threshold;
-    switchController.setTH(threshold);
+    threshold = USE_Power_Domain ? fix_threshold * fix_threshold : fix_threshold;
 
-    smooth_power.setK(smooth_theta_k);
+    // band-ratio gate; the filters and windows restart when it is turned on or their own settings change
+    s.ratioGate = USE_Band_Ratio && (ratio_low < ratio_high);
+    s.ratioThreshold = ratio_threshold;
+    if (s.ratioGate) {
+        if (!posted.ratioGate || freqLow != posted.ratioThetaLow || freqHigh != posted.ratioThetaHigh ||
+            ratio_low != posted.ratioLow || ratio_high != posted.ratioHigh || rfs != posted.ratioRate) {
+            r->ratioThetaBandpass = std::make_unique<BandpassFilter>();
+            r->ratioThetaBandpass->setup(BandpassDesign::BUTTERWORTH, rfs, freqLow, freqHigh, (freqLow + freqHigh) / 2.0, 0);
+            r->ratioRefBandpass = std::make_unique<BandpassFilter>();
+            r->ratioRefBandpass->setup(BandpassDesign::BUTTERWORTH, rfs, ratio_low, ratio_high, (ratio_low + ratio_high) / 2.0, 0);
+            s.ratioThetaLow = freqLow;
+            s.ratioThetaHigh = freqHigh;
+            s.ratioLow = ratio_low;
+            s.ratioHigh = ratio_high;
+            s.ratioRate = rfs;
+        }
+        RMS_nsamp = std::max((int)(rfs * ratio_window), 1);
+        r->ratioWindowChanged = !posted.ratioGate || (RMS_nsamp != posted.ratioSamples);
+        if (r->ratioWindowChanged) {
+            r->rmsTheta.setSize(RMS_nsamp);
+            r->rmsRef.setSize(RMS_nsamp);
+            s.ratioSamples = RMS_nsamp;
+        }
+    }
 
-    // RMS
-    // rms_theta.setSize(RMS_nsamp);
+    // SDFT, on the short window when a long one confirms
+    int nfft = USE_Two_Stage ? std::max((int)(rfs * alert_window_size), 1) : SDFT_nfft;
+    bool configured = posted.nfft > 0;
+    int fmin = (freqLow < freqHigh) ? (int)freqLow : (configured ? posted.fmin : 4);
+    int fmax = (freqLow < freqHigh) ? (int)freqHigh : (configured ? posted.fmax : 8);
+    SdftType engineType = sdft_type;
+    if (sdft_type == SdftType::AutoEngine) {
+        engineType = EngineSelector::get().select(fmin, fmax, nfft, rfs, sdft_hop, latency_budget);
+    }
+    s.engineType = engineType;
+    s.fmin = fmin;
+    s.fmax = fmax;
+    s.nfft = nfft;
+    s.rfs = rfs;
+    s.hop = sdft_hop;
+    s.useBandpass = USE_Bandpassfilter;
+    s.useMinusAverage = USE_Minus_Average;
+    s.useSmooth = USE_Smooth;
+    s.useAutoTH = USE_Auto_TH;
+    s.usePowerDomain = USE_Power_Domain;
+    // Parseval only ties the window's RMS to its bins for the rectangular window
+    s.useRelativePower = USE_Relative_Power && (engineType == SdftType::RECTANGLE);
+    if (USE_Relative_Power && !s.useRelativePower) {
+        std::cout << "[Error] Relative power needs the Rectangle window, not " << EngineSelector::getName(engineType)
+            << ": band power stays absolute" << std::endl;
+    }
+    // same time constant at the hop rate
+    s.smoothK = 1.0 - std::pow(1.0 - smooth_theta_k, sdft_hop);
+    s.stdTH = STD_TH;
+    s.threshold = threshold;
 
-    // SDFT
-    if (sdft == nullptr || sdft->type != sdft_type) {
-        sdft = createSDFTInstance(sdft_type);
+    bool engineChanged = !configured || (s.engineType != posted.engineType) ||
+        (s.fmin != posted.fmin) || (s.fmax != posted.fmax) || (s.nfft != posted.nfft) || (s.rfs != posted.rfs);
+    bool stagesChanged = (s.useMinusAverage != posted.useMinusAverage) ||
+        (s.useSmooth != posted.useSmooth) || (s.useAutoTH != posted.useAutoTH) ||
+        (s.usePowerDomain != posted.usePowerDomain) || (s.useRelativePower != posted.useRelativePower) ||
+        (s.hop != posted.hop) || (s.smoothK != posted.smoothK);
+    // band power changes units: the learned statistics are of no use in the new ones
+    bool unitsChanged = (s.useRelativePower != posted.useRelativePower) || (s.usePowerDomain != posted.usePowerDomain);
+    if (engineChanged || stagesChanged) {
+        // the running engine keeps detecting until this one has caught up on the history;
+        // a new engine is the only way the power domain changes, with or without history
+        r->sdft = createSDFTInstance(engineType);
+        r->sdft->configure(fmin, fmax, nfft, rfs);
+        r->sdft->setPowerDomain(USE_Power_Domain);
+        // engine and controller count the hop from the same sample
+        r->sdft->setHop(sdft_hop);
+        s.n = r->sdft->get_n();
+        r->slidingWindow.setWindowSize(nfft);
+        r->smoothPower.setK(s.smoothK);
+        r->smoothPower.setN(s.n);
+        r->stdPower.setN(s.n);
+        r->rmsTotal.setSize(nfft);
+        r->power.assign(s.n, 0.0);
+        r->autoThresholds.assign(s.n, 0.0);
+        r->replay.reserve(HISTORY_WINDOWS * posted.nfft);
+        r->position = 0;
+        r->hopCount = 0;
+    }
+    if (nfft != posted.nfft) {
+        r->history.assign(HISTORY_WINDOWS * nfft, 0.0f);
     }
-    sdft->setSampleRate(rfs);
-    sdft->setNfft(SDFT_nfft);
-    if (freqLow < freqHigh) {
-        sdft->setFreqs(freqLow, freqHigh);
+
+    if (USE_Bandpassfilter && (bandpassLow < bandpassHigh)) {
+        // the delay that matters is the one at the detection band
+        double center = (freqLow + freqHigh) / 2.0;
+        bool designed = posted.bandpassLow < posted.bandpassHigh;
+        if (!designed || bandpass_design != posted.bandpassDesign || bandpassLow != posted.bandpassLow ||
+            bandpassHigh != posted.bandpassHigh || center != posted.bandCenter ||
+            delay_budget != posted.delayBudget || rfs != posted.bandpassRate) {
+            r->bandpass = std::make_unique<BandpassFilter>();
+            r->bandpass->setup(bandpass_design, rfs, bandpassLow, bandpassHigh, center, delay_budget);
+            bandpassDelay = r->bandpass->getGroupDelay();
+            s.bandpassDesign = bandpass_design;
+            s.bandpassLow = bandpassLow;
+            s.bandpassHigh = bandpassHigh;
+            s.bandCenter = center;
+            s.delayBudget = delay_budget;
+            s.bandpassRate = rfs;
+        }
     }
 
-    slidingWindow.setWindowSize(SDFT_nfft);
+    s.sampleRate = fs;
+    // durations are counted in hops
+    s.hopRate = (double)rfs / sdft_hop;
+    s.twindow = twindow;
+    s.onsetDetector = onset_detector;
+    s.falseAlarmRate = false_alarm_rate;
+    s.lightDur = lightDur;
+    s.ignoreDur = ignoreDur;
+    s.holdDur = holdDur;
+    s.clearDur = clearDur;
+    s.randomDelay = std::make_pair((double)delayMin, (double)delayMax);
+    s.randomSeed = random_seed;
+    s.delayEnabled = isDelayEnabled;
+    if (!configured || (s.n != posted.n) || (s.hopRate != posted.hopRate) || (s.twindow != posted.twindow) ||
+        (s.onsetDetector != posted.onsetDetector) || (s.falseAlarmRate != posted.falseAlarmRate)) {
+        r->crossings = std::make_unique<CrossingBank>();
+        SwitchController::setupCrossings(*r->crossings, s.n, s.hopRate, s.twindow, s.onsetDetector,
+            s.falseAlarmRate, s.threshold);
+    }
 
-    int n = sdft->get_n();
-    switchController.setN(n);
-    std_power.setN(n);
-    smooth_power.setN(n);
+    if (engineChanged || s.hop != posted.hop) {
+        printEngineCosts(fmin, fmax, nfft);
+        if (sdft_type == SdftType::AutoEngine) {
+            const EngineSelector& selector = EngineSelector::get();
+            std::cout << "Auto SDFT engine: " << EngineSelector::getName(engineType)
+                << ", " << selector.costNs(engineType, fmin, fmax, nfft, rfs, sdft_hop) << " ns/sample on this CPU"
+                << ", resolution " << selector.resolutionHz(engineType, nfft, rfs) << " Hz"
+                << ", latency " << selector.latencyMs(engineType, nfft, rfs, sdft_hop) << " ms" << std::endl;
+        }
+    }
 
-    if (USE_Bandpassfilter && (bandpassLow < bandpassHigh)) {
-        bandpass.setup(rfs, (bandpassLow + bandpassHigh) / 2.0, bandpassHigh - bandpassLow);
-        bandpass.reset();
+    // the confirmation stage is rebuilt with its window or units, and its
+    // threshold learns again from scratch
+    s.twoStage = USE_Two_Stage;
+    s.confirmNfft = USE_Two_Stage ? SDFT_nfft : 0;
+    s.confirmDelay = SDFT_nfft / CONFIRM_WAIT;
+    if (USE_Two_Stage) {
+        r->confirmChanged = !posted.twoStage || (s.confirmNfft != posted.confirmNfft) ||
+            (s.fmin != posted.fmin) || (s.fmax != posted.fmax) || (s.rfs != posted.rfs) || unitsChanged;
+    }
+    else {
+        r->confirmChanged = posted.twoStage;
+    }
+    if (USE_Two_Stage && r->confirmChanged) {
+        r->confirmSdft = std::make_unique<RealtimeSTFT>();
+        r->confirmSdft->configure(fmin, fmax, SDFT_nfft, rfs);
+        r->confirmSdft->setHop(0);
+        r->confirmSdft->setPowerDomain(USE_Power_Domain);
+        int n = r->confirmSdft->get_n();
+        r->confirmStd.setN(n);
+        r->confirmPower.assign(n, 0.0);
+        r->confirmThresholds.assign(n, 0.0);
     }
+
+    // after an artifact the blanked samples stay in the windows, through the
+    // sliding average as well, and the prefilter rings for a while
+    int span = std::max(s.nfft, s.confirmNfft) * (USE_Minus_Average ? 2 : 1);
+    if (s.ratioGate) {
+        span = std::max(span, s.ratioSamples);
+    }
+    double settle = USE_Bandpassfilter ? SETTLE_DELAYS * bandpassDelay * rfs / 1000.0 : 0.0;
+    s.frozenHold = span + (int)std::ceil(settle);
+
+    r->processFunctions[0] = chooseProcessFunction(s, false);
+    r->processFunctions[1] = chooseProcessFunction(s, true);
+
+    posted = s;
+    reconfigurations.post(std::move(r));
 }
 
-std::unique_ptr<RealtimeSDFT> OcsController::createSDFTInstance(SdftType type) {
-    if (SdftType::RECTANGLE == type) {
-        return std::make_unique<RealtimeSDFT>();
+void OcsController::printEngineCosts(int fmin, int fmax, int nfft)
+{
+    SdftType cheapest = SdftType::RECTANGLE;
+    double cheapestCost = 0;
+    std::cout << "SDFT cost per sample (flops):";
+    for (int type = SdftType::RECTANGLE; type < SdftType::SDFT_TYPES; type++) {
+        if (type == SdftType::AutoEngine) {
+            continue;
+        }
+        double cost = estimateEngineCost((SdftType)type, fmin, fmax, nfft, rfs, sdft_hop);
+        std::cout << " " << EngineSelector::getName((SdftType)type) << " " << cost;
+        if (type == SdftType::RECTANGLE || cost < cheapestCost) {
+            cheapest = (SdftType)type;
+            cheapestCost = cost;
+        }
+    }
+    std::cout << ", cheapest: " << EngineSelector::getName(cheapest) << std::endl;
+}
+
+OcsController::ProcessFunction OcsController::chooseProcessFunction(const Settings& s, bool frozen) const
+{
+    // frozen hops skip the smoothing and the statistics, so those instantiations are shared
+    int flags = (s.useBandpass ? 1 : 0) | (s.useMinusAverage ? 2 : 0) | (s.ratioGate ? 32 : 0) | (s.twoStage ? 16 : 0) |
+        (frozen ? 64 : ((s.useSmooth ? 4 : 0) | (s.useAutoTH ? 8 : 0)));
+    auto allFlags = std::make_index_sequence<128>();
+    switch (s.engineType) {
+    case SdftType::EXP:
+        return selectProcessFunction<RealtimeExpSDFT>(flags, allFlags);
+    case SdftType::ZeroPaddingExp:
+        return selectProcessFunction<RealtimeZeroPaddingExpSDFT>(flags, allFlags);
+    case SdftType::MirrorExp:
+        return selectProcessFunction<RealtimeMirrorExpSDFT>(flags, allFlags);
+    case SdftType::HoppedSTFT:
+        return selectProcessFunction<RealtimeSTFT>(flags, allFlags);
+    case SdftType::ConstantQ:
+        return selectProcessFunction<RealtimeConstantQ>(flags, allFlags);
+    case SdftType::HilbertEnvelope:
+        return selectProcessFunction<RealtimeHilbert>(flags, allFlags);
+    case SdftType::ComplexDemod:
+        return selectProcessFunction<RealtimeDemodulator>(flags, allFlags);
+    case SdftType::MultiWindow:
+        return selectProcessFunction<RealtimeMultiWindowSDFT>(flags, allFlags);
+    default:
+        if (s.useRelativePower) {
+            return selectProcessFunction<RealtimeSDFT, true>(flags, allFlags);
+        }
+        return selectProcessFunction<RealtimeSDFT>(flags, allFlags);
     }
-    else if (SdftType::EXP == type) {
-        return std::make_unique<RealtimeExpSDFT>();
+}
+
+/* Band-ratio gate */
+void OcsController::ratioStage(float sample)
+{
+    rms_theta.addSample(ratioThetaBandpass->filter(sample));
+    rms_ref.addSample(ratioRefBandpass->filter(sample));
+}
+
+void OcsController::updateRatioGate()
+{
+    // a power ratio, as theta / delta ratios are usually given
+    double ref = rms_ref.getRes();
+    double theta = rms_theta.getRes();
+    bandRatio = (ref > 0) ? (theta * theta) / (ref * ref) : 0.0;
+    switchController.setGate(bandRatio >= active.ratioThreshold);
+}
+
+void OcsController::setFrozen(bool gated)
+{
+    frozenLeft = gated ? active.frozenHold : std::max(frozenLeft - 1, 0);
+}
+
+/* Two-stage detection */
+void OcsController::confirmStage()
+{
+    baselineCount += active.hop;
+    // the threshold learns from one value per window, so consecutive ones do not overlap
+    bool baseline = active.useAutoTH && (baselineCount >= confirmSdft->nfft);
+    // one look per alert, once the long window holds some of it: right at the alert
+    // the long window shares the noise peak that raised it
+    long long alertAge = (tsBuffer - switchController.tsAlert) * active.hop;
+    bool check = switchController.isAlertPending() && (alertAge >= active.confirmDelay);
+    if (!baseline && !check) {
+        return;
+    }
+    confirmSdft->transform();
+    confirmSdft->getBandPowerList(confirmPower);
+    if (active.useRelativePower) {
+        toRelativePower(confirmPower, confirmSdft->getFrameRms(), active.usePowerDomain);
     }
-    else if (SdftType::ZeroPaddingExp == type) {
-        return std::make_unique<RealtimeZeroPaddingExpSDFT>();
+
+    if (check) {
+        if (active.useAutoTH) {
+            confirmStd.getResN(active.stdTH, confirmThresholds);
+        }
+        bool confirmed = false;
+        for (int i = 0; i < (int)confirmPower.size(); i++) {
+            confirmed = confirmed || (confirmPower[i] >= (active.useAutoTH ? confirmThresholds[i] : active.threshold));
+        }
+        switchController.resolveAlert(confirmed, tsBuffer);
+    }
+    if (baseline) {
+        baselineCount = 0;
+        confirmStd.addSamples(confirmPower);
     }
-    else if (SdftType::MirrorExp == type) {
-        return std::make_unique<RealtimeMirrorExpSDFT>();
+}
+
+/* Reconfiguration */
+void OcsController::applyPending()
+{
+    // audio thread, or the message thread while the audio thread is stopped
+    if (Reconfiguration* done = warmDone.exchange(nullptr, std::memory_order_acquire)) {
+        // catch up on the samples that arrived while the history was replayed
+        int size = (int)history.size();
+        long long behind = std::min<long long>(historyCount - done->position, size);
+        for (long long k = behind; k > 0; k--) {
+            feedPending(*done, history[(historyIndex - k + size) % size]);
+        }
+        warmInFlight = false;
+        install(done);
+    }
+    if (warmInFlight) {
+        // the next configuration waits for this one
+        return;
+    }
+    Reconfiguration* r = reconfigurations.take();
+    if (r == nullptr) {
+        return;
+    }
+    if (r->sdft && historyCount > 0) {
+        // the replay fits the reserved capacity: the history has not grown since r was built
+        int size = (int)history.size();
+        int count = (int)std::min<long long>(historyCount, size);
+        r->replay.resize(count);
+        for (int i = 0; i < count; i++) {
+            r->replay[i] = history[(historyIndex - count + i + size) % size];
+        }
+        r->position = historyCount;
+        warmInFlight = true;
+        warmJob.store(r, std::memory_order_release);
+        warmCv.notify_one();
     }
     else {
-        throw std::invalid_argument("Invalid choice");
+        install(r);
+    }
+}
+
+void OcsController::install(Reconfiguration* r)
+{
+    const Settings& s = r->settings;
+    if (!r->history.empty()) {
+        resizeHistory(r->history);
+    }
+    if (r->sdft) {
+        sdft.swap(r->sdft);
+        std::swap(slidingWindow, r->slidingWindow);
+        std::swap(smooth_power, r->smoothPower);
+        std::swap(std_power, r->stdPower);
+        std::swap(rms_total, r->rmsTotal);
+        power.swap(r->power);
+        autoThresholds.swap(r->autoThresholds);
+        hopCount = r->hopCount;
+    }
+    if (r->bandpass) {
+        bandpass.swap(r->bandpass);
+    }
+    if (r->confirmChanged) {
+        // without two-stage detection this swaps in an empty stage
+        confirmSdft.swap(r->confirmSdft);
+        std::swap(confirmStd, r->confirmStd);
+        confirmPower.swap(r->confirmPower);
+        confirmThresholds.swap(r->confirmThresholds);
+        baselineCount = 0;
+        // a pending alert was raised for the stage that just went away
+        switchController.alertPending = false;
+    }
+    if (r->ratioThetaBandpass) {
+        ratioThetaBandpass.swap(r->ratioThetaBandpass);
+        ratioRefBandpass.swap(r->ratioRefBandpass);
+    }
+    if (r->ratioWindowChanged) {
+        std::swap(rms_theta, r->rmsTheta);
+        std::swap(rms_ref, r->rmsRef);
+    }
+    if (!s.ratioGate) {
+        // the last ratio no longer holds crossings back
+        switchController.setGate(true);
+    }
+
+    SwitchController& c = switchController;
+    c.sampleRate = s.sampleRate;
+    c.rfs = s.hopRate;
+    c.twindow = s.twindow;
+    c.onsetDetector = s.onsetDetector;
+    c.falseAlarmRate = s.falseAlarmRate;
+    c.lightDur = s.lightDur;
+    c.ignoreDur = s.ignoreDur;
+    c.holdDur = s.holdDur;
+    c.clearDur = s.clearDur;
+    c.random_delay = s.randomDelay;
+    c.random_seed = s.randomSeed;
+    c.isDelayEnabled = s.delayEnabled;
+    c.twoStage = s.twoStage;
+    if (r->crossings) {
+        c.swapCrossings(*r->crossings);
+    }
+    c.setTH(s.threshold);
+
+    active = s;
+    processFunctions[0] = r->processFunctions[0];
+    processFunctions[1] = r->processFunctions[1];
+    reconfigurations.release(r);
+}
+
+/* Warm start */
+void OcsController::resizeHistory(std::vector<float>& resized)
+{
+    // keep the newest samples, oldest first
+    int size = (int)history.size();
+    int capacity = (int)resized.size();
+    int count = (int)std::min<long long>(std::min<long long>(historyCount, size), capacity);
+    for (int i = 0; i < count; i++) {
+        resized[i] = history[(historyIndex - count + i + size) % size];
+    }
+    history.swap(resized);
+    historyIndex = count % capacity;
+    historyCount = count;
+}
+
+void OcsController::feedPending(Reconfiguration& r, float sample)
+{
+    const Settings& s = r.settings;
+    if (s.useMinusAverage) {
+        sample = r.slidingWindow.addSample(sample);
+    }
+    r.sdft->addSample(sample);
+    if (s.useRelativePower) {
+        r.rmsTotal.addSample(sample);
+    }
+    if (++r.hopCount < s.hop) {
+        return;
+    }
+    r.hopCount = 0;
+    r.sdft->getBandPowerList(r.power);
+    if (s.useRelativePower) {
+        toRelativePower(r.power, r.rmsTotal.getRes(), s.usePowerDomain);
     }
+    if (s.useSmooth) {
+        r.smoothPower.addSamples(r.power);
+        r.smoothPower.getRes(r.power);
+    }
+    if (s.useAutoTH) {
+        r.stdPower.addSamples(r.power);
+    }
+}
+
+void OcsController::warmStartLoop()
+{
+    std::unique_lock<std::mutex> lock(warmMutex);
+    while (true) {
+        // the audio thread does not lock to wake the worker, so a missed wakeup is caught by polling
+        warmCv.wait_for(lock, WARM_POLL, [this] {
+            return warmExiting || warmJob.load(std::memory_order_acquire) != nullptr;
+        });
+        Reconfiguration* r = warmJob.load(std::memory_order_acquire);
+        if (r != nullptr) {
+            lock.unlock();
+            for (float sample : r->replay) {
+                feedPending(*r, sample);
+            }
+            lock.lock();
+            warmJob.store(nullptr, std::memory_order_relaxed);
+            warmDone.store(r, std::memory_order_release);
+            warmCv.notify_all();
+        }
+        if (warmExiting) {
+            return;
+        }
+    }
+}
+
+void OcsController::waitWarmIdle()
+{
+    std::unique_lock<std::mutex> lock(warmMutex);
+    warmCv.wait(lock, [this] { return warmJob.load(std::memory_order_acquire) == nullptr; });
+}
+
+std::unique_ptr<RealtimeSDFT> OcsController::createSDFTInstance(SdftType type) {
+    return EngineSelector::create(type);
 }
@@ -2,11 +2,18 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <utility>
 #include <vector>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #ifndef OCSCONTROLLER_H
 #define OCSCONTROLLER_H
 
 #include "iir/Butterworth.h"
+#include "BandpassFilter.h"
+#include "Handoff.h"
 #include "SwitchController.h"
 #include "utils.h"
 
@@ -21,6 +28,9 @@ public:
 	float getFreqHigh();
 	float getBandpassLow();
 	float getBandpassHigh();
+	int getBandpassDesign();
+	float getDelayBudget();
+	double getBandpassDelay();
 	float getFixThreshold();
 	float getDelayMin();
 	float getDelayMax();
@@ -30,9 +40,19 @@ public:
 	float getSmoothK();
 	int getSdftType();
 	float getSdftWindowSize();
+	float getAlertWindowSize();
+	int getSdftHop();
+	float getLatencyBudget();
 	float getDurTime();
+	int getOnsetDetector();
+	float getFalseAlarmRate();
 	float getLightDur();
 	float getIgnoreDur();
+	float getRatioLow();
+	float getRatioHigh();
+	float getRatioThreshold();
+	float getRatioWindow();
+	double getBandRatio();
 
 	bool get_use_delay();
 	bool get_use_stft();
@@ -40,6 +60,12 @@ public:
 	bool get_use_minus_average();
 	bool get_use_bandpass_filter();
 	bool get_use_smooth();
+	bool get_use_power_domain();
+	bool get_use_relative_power();
+	bool get_use_two_stage();
+	bool get_use_band_ratio();
+	// alerts raised, confirmed and cancelled, mean confirmation delay (s)
+	std::tuple<int, int, int, double> getAlertStats();
 
 	int get_rfs_factor();
 	int get_fs();
@@ -48,14 +74,143 @@ public:
 	void parameterValueChange(std::string name, double value);
 
 	std::tuple<int, double> process(float ptrT);
+	// every stage of one sample: input, bandpassed, minus average, then the n
+	// band powers, smoothed and thresholds, then light, crossing and is_over
 	std::vector<double> process2(float ptrT);
 
 	void clear_all();
 	void init();
+	// once per sample, before process(): a gated sample (an artifact) freezes
+	// detection until its blanked samples have left the windows and the
+	// prefilter has settled. While frozen, hops leave the statistics, the
+	// crossings and the confirmation alone and only run the light timers
+	void setFrozen(bool gated);
 
 	std::unique_ptr<RealtimeSDFT> createSDFTInstance(SdftType type);
 
 private:
+	typedef std::tuple<int, double> (OcsController::*ProcessFunction)(float);
+
+	// one instantiation per engine type and stage set, picked once per configuration
+	template <class Engine, bool Bandpass, bool MinusAverage, bool SmoothPower, bool AutoThreshold, bool TwoStage,
+		bool RatioGate, bool Relative, bool Frozen>
+	std::tuple<int, double> processSpecialized(float sample);
+	// relative power is only instantiated for the rectangular SDFT
+	template <class Engine, bool Relative = false, size_t... Flags>
+	static ProcessFunction selectProcessFunction(int flags, std::index_sequence<Flags...>);
+	ProcessFunction processFunctions[2];	// running, frozen
+	std::vector<double> power, autoThresholds;
+	void printEngineCosts(int fmin, int fmax, int nfft);
+	void confirmStage();
+	void ratioStage(float sample);
+	void updateRatioGate();
+
+	// what the audio thread runs with; only init() reads the parameters
+	struct Settings
+	{
+		SdftType engineType;
+		int fmin, fmax, nfft, rfs, n;
+		int hop;
+		bool useBandpass, useMinusAverage, useSmooth, useAutoTH, usePowerDomain, useRelativePower;
+		double smoothK;
+		float stdTH;
+		double threshold;	// constant, squared in the power domain
+
+		// the bandpass design that was last built
+		BandpassDesign bandpassDesign;
+		double bandpassLow, bandpassHigh, bandCenter, delayBudget;
+		int bandpassRate;
+
+		// switch controller, durations in s and counted at hopRate
+		int sampleRate;
+		double hopRate, twindow, falseAlarmRate;
+		OnsetDetector onsetDetector;
+		double lightDur, ignoreDur, holdDur, clearDur;
+		std::pair<double, double> randomDelay;
+		int randomSeed;
+		bool delayEnabled;
+
+		// two-stage confirmation over the long window
+		bool twoStage;
+		int confirmNfft, confirmDelay;
+
+		// band-ratio gate, and the bands and window it was last built with
+		bool ratioGate;
+		double ratioThreshold;
+		double ratioThetaLow, ratioThetaHigh, ratioLow, ratioHigh;
+		int ratioRate, ratioSamples;
+
+		int frozenHold;	// samples frozen after a gated one
+	};
+
+	// A configuration built on the message thread and put in place by the audio
+	// thread in one step. Only what changed is built, from scratch; the audio
+	// thread swaps it in and releases the item holding the objects it replaced.
+	struct Reconfiguration
+	{
+		Settings settings;
+		Settings from;	// the settings it was built against
+		ProcessFunction processFunctions[2];
+
+		// a new engine and the stages behind it, warm started from the history
+		std::unique_ptr<RealtimeSDFT> sdft;
+		SlidingWindow slidingWindow;
+		SmoothList smoothPower;
+		STDList stdPower;
+		RMS rmsTotal;
+		std::vector<double> power, autoThresholds;
+		std::vector<float> replay;	// reserved for the whole history
+		long long position;	// historyCount when the replay was taken
+		int hopCount;
+
+		std::unique_ptr<BandpassFilter> bandpass;
+		std::unique_ptr<CrossingBank> crossings;
+		std::vector<float> history;	// a new capacity, empty to keep the history
+
+		// a new confirmation stage, or none when two-stage detection is turned off;
+		// it goes in together with the switch controller's twoStage flag
+		bool confirmChanged;
+		std::unique_ptr<RealtimeSTFT> confirmSdft;
+		STDList confirmStd;
+		std::vector<double> confirmPower, confirmThresholds;
+
+		// new ratio gate bands, and new RMS windows when ratioWindowChanged
+		std::unique_ptr<BandpassFilter> ratioThetaBandpass, ratioRefBandpass;
+		bool ratioWindowChanged;
+		RMS rmsTheta, rmsRef;
+
+		Reconfiguration* releasedNext;
+	};
+
+	ProcessFunction chooseProcessFunction(const Settings& settings, bool frozen) const;
+	void applyPending();
+	void install(Reconfiguration* r);
+
+	// warm start: the last few windows of bandpassed samples are kept so that a
+	// new average, engine and statistics can be rebuilt in the background, while
+	// the running ones keep detecting
+	void pushHistory(float sample);
+	void resizeHistory(std::vector<float>& resized);
+	void feedPending(Reconfiguration& r, float sample);
+	void warmStartLoop();
+	void waitWarmIdle();
+	std::vector<float> history;
+	int historyIndex;
+	long long historyCount;
+
+	Handoff<Reconfiguration> reconfigurations;
+	Settings posted;	// message thread: what the audio thread runs once it took everything posted
+	Settings active;	// audio thread
+	double bandpassDelay;	// ms, of the last bandpass design
+
+	// the audio thread hands one item at a time to the worker and adopts it when done
+	std::thread warmWorker;
+	std::mutex warmMutex;
+	std::condition_variable warmCv;
+	bool warmExiting;
+	bool warmInFlight;	// audio thread
+	std::atomic<Reconfiguration*> warmJob, warmDone;
+
 	float freqHigh, freqLow;
 
 	bool USE_Auto_TH;
@@ -63,6 +218,8 @@ private:
 
 	bool USE_Bandpassfilter;
 	float bandpassLow, bandpassHigh;
+	BandpassDesign bandpass_design;
+	float delay_budget;
 	
 	bool USE_Minus_Average;
 	bool USE_Smooth;
@@ -71,11 +228,22 @@ private:
 	bool USE_STFT;
 	SdftType sdft_type;
 	float sdft_window_size;
+	// bins update every sample, band power and everything after it every sdft_hop samples
+	int sdft_hop;
+	int hopCount;
+	float latency_budget;	// ms, for the automatic engine choice
+	bool USE_Power_Domain;
+	// band power in units of the RMS of the engine's window of input samples:
+	// by Parseval the window's energy is the whole spectrum's, without its bins.
+	// That only holds for the rectangular window, so the other engines ignore it;
+	// the Hann confirmation STFT takes the RMS of its windowed frame instead
+	bool USE_Relative_Power;
+	RMS rms_total;	// over the engine's window
 
 	bool isDelayEnabled;
 	float delayMin, delayMax;
 
-	Iir::Butterworth::BandPass<1> bandpass;
+	std::unique_ptr<BandpassFilter> bandpass;
 
 	// RealtimeSTD out_std;
 	SmoothList  smooth_power;
@@ -84,15 +252,36 @@ private:
 	STDList std_power;
 	int fs, rfs;
 
+	// band-ratio gate: detection band power over the power of a reference band
+	// (e.g. theta / delta), both as RMS over ratio_window of their own bandpass;
+	// switchController only starts crossings while the ratio reaches ratio_threshold;
+	// the gate is on with a valid reference band
+	bool USE_Band_Ratio;
+	float ratio_low, ratio_high, ratio_threshold, ratio_window;
+	std::unique_ptr<BandpassFilter> ratioThetaBandpass, ratioRefBandpass;
 	RMS rms_ref, rms_theta;
 	int RMS_nsamp;
+	double bandRatio;
+	int frozenLeft;	// audio thread
 
 	std::unique_ptr<RealtimeSDFT> sdft;
 	int SDFT_nfft;
 
+	// two-stage detection: sdft runs on the short alert window, and a Hann STFT
+	// over SDFT_nfft is only transformed once per alert, to confirm or cancel it,
+	// and once per window, to learn its own threshold
+	bool USE_Two_Stage;
+	float alert_window_size;
+	std::unique_ptr<RealtimeSTFT> confirmSdft;
+	STDList confirmStd;
+	std::vector<double> confirmPower, confirmThresholds;
+	int baselineCount;	// audio thread
+
 	SwitchController switchController;
 	SlidingWindow slidingWindow;
 	float twindow;
+	OnsetDetector onset_detector;
+	float false_alarm_rate;	// per minute, for the CUSUM onset
 	float lightDur, ignoreDur, holdDur, clearDur;
 
 	int random_seed;
@@ -122,6 +311,21 @@ inline float OcsController::getBandpassHigh()
 	return bandpassHigh;
 }
 
+inline int OcsController::getBandpassDesign()
+{
+	return bandpass_design;
+}
+
+inline float OcsController::getDelayBudget()
+{
+	return delay_budget;
+}
+
+inline double OcsController::getBandpassDelay()
+{
+	return bandpassDelay;
+}
+
 inline float OcsController::getFixThreshold()
 {
 	return fix_threshold;
@@ -169,11 +373,36 @@ inline float OcsController::getSdftWindowSize()
 	return sdft_window_size;
 }
 
+inline int OcsController::getSdftHop()
+{
+	return sdft_hop;
+}
+
+inline float OcsController::getAlertWindowSize()
+{
+	return alert_window_size;
+}
+
+inline float OcsController::getLatencyBudget()
+{
+	return latency_budget;
+}
+
 inline float OcsController::getDurTime()
 {
 	return twindow;
 }
 
+inline int OcsController::getOnsetDetector()
+{
+	return onset_detector;
+}
+
+inline float OcsController::getFalseAlarmRate()
+{
+	return false_alarm_rate;
+}
+
 inline float OcsController::getLightDur()
 {
 	return lightDur;
@@ -184,6 +413,31 @@ inline float OcsController::getIgnoreDur()
 	return ignoreDur;
 }
 
+inline float OcsController::getRatioLow()
+{
+	return ratio_low;
+}
+
+inline float OcsController::getRatioHigh()
+{
+	return ratio_high;
+}
+
+inline float OcsController::getRatioThreshold()
+{
+	return ratio_threshold;
+}
+
+inline float OcsController::getRatioWindow()
+{
+	return ratio_window;
+}
+
+inline double OcsController::getBandRatio()
+{
+	return bandRatio;
+}
+
 inline bool OcsController::get_use_delay()
 {
 	return isDelayEnabled;
@@ -214,6 +468,33 @@ inline bool OcsController::get_use_smooth()
 	return USE_Smooth;
 }
 
+inline bool OcsController::get_use_power_domain()
+{
+	return USE_Power_Domain;
+}
+
+inline bool OcsController::get_use_relative_power()
+{
+	return USE_Relative_Power;
+}
+
+inline bool OcsController::get_use_two_stage()
+{
+	return USE_Two_Stage;
+}
+
+inline bool OcsController::get_use_band_ratio()
+{
+	return USE_Band_Ratio;
+}
+
+inline std::tuple<int, int, int, double> OcsController::getAlertStats()
+{
+	const SwitchController& s = switchController;
+	return std::make_tuple(s.alertsRaised, s.alertsConfirmed, s.alertsCancelled,
+		s.alertsConfirmed > 0 ? s.confirmDelaySum / s.alertsConfirmed : 0.0);
+}
+
 inline int OcsController::get_rfs_factor()
 {
 	return (int)(fs/rfs); 
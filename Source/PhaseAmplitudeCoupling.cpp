@@ -0,0 +1,176 @@
+#include "PhaseAmplitudeCoupling.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const double SCALE_LIMIT = 1e150;	// renormalize the histograms past this weight
+
+
+/* PhaseAmplitudeCoupling */
+PhaseAmplitudeCoupling::PhaseAmplitudeCoupling() :
+	nChannels(0), hopRate(1), decay(1), threshold(0), emphasisGain(1), hops(0), warmupHops(1), nextChannel(0), combDelay(1), historyPos(0), scale(1), delayRotation(1.0, 0.0)
+{
+}
+
+void PhaseAmplitudeCoupling::setup(int nChannels, double sampleRate, double ampLow, double ampHigh, int hop,
+	double phaseCenter, double timeConstant, double threshold)
+{
+	this->nChannels = std::max(nChannels, 0);
+	hop = std::max(hop, 1);
+
+	// as ChannelVoting: the CIC is 3 dB down at half the band width
+	double center = std::min((ampLow + ampHigh) / 2.0, 0.45 * sampleRate);
+	double width = std::min(std::max(ampHigh - ampLow, 1.0), 0.45 * sampleRate);
+	int cicLength = std::max((int)std::lround(0.64 * sampleRate / width), 1);
+	demodulator.setup(this->nChannels, sampleRate, center, cicLength, hop);
+	// |1 - z^-D|^2 at the band centre, to keep the amplitudes in input units
+	combDelay = std::max((int)std::lround(sampleRate / (2.0 * center)), 1);
+	emphasisGain = 1.0 / std::pow(2.0 * std::sin(M_PI * center * combDelay / sampleRate), 2);
+	emphasized.assign(this->nChannels, 0.0f);
+	history.assign(2 * combDelay * this->nChannels, 0.0f);
+	historyPos = 0;
+	// the amplitude lags by the comb and the CIC
+	delayRotation = std::polar(1.0, -2.0 * M_PI * phaseCenter * (combDelay + demodulator.getDelay()) / sampleRate);
+
+	hopRate = sampleRate / hop;
+	setTimeConstant(timeConstant, threshold);
+
+	amplitudeSum.assign(this->nChannels * PAC_BINS, 0.0);
+	weightSum.assign(this->nChannels * PAC_BINS, 0.0);
+	channelOn.assign(this->nChannels, 0);
+	channelChanged.assign(this->nChannels, 0);
+	hops = 0;
+	nextChannel = 0;
+	scale = 1;
+}
+
+void PhaseAmplitudeCoupling::setTimeConstant(double timeConstant, double threshold)
+{
+	this->threshold = threshold;
+	decay = (timeConstant > 0) ? std::exp(-1.0 / (hopRate * timeConstant)) : 1.0;	// 0: never forget
+	warmupHops = std::max((int)std::ceil(hopRate * timeConstant), 1);
+	// a channel that is on goes off with an event once its turn comes, if it has to
+	std::fill(channelChanged.begin(), channelChanged.end(), 0);
+}
+
+void PhaseAmplitudeCoupling::clear()
+{
+	demodulator.reset();
+	std::fill(history.begin(), history.end(), 0.0f);
+	historyPos = 0;
+	std::fill(amplitudeSum.begin(), amplitudeSum.end(), 0.0);
+	std::fill(weightSum.begin(), weightSum.end(), 0.0);
+	std::fill(channelOn.begin(), channelOn.end(), 0);
+	std::fill(channelChanged.begin(), channelChanged.end(), 0);
+	hops = 0;
+	nextChannel = 0;
+	scale = 1;
+}
+
+bool PhaseAmplitudeCoupling::process(const float* frame, const std::complex<double>* phaseBins, std::complex<double> phaseOscillator)
+{
+	// x[t] - 2 x[t - D] + x[t - 2D]; the slot of x[t - 2D] takes x[t]
+	float* oldest = &history[historyPos * nChannels];
+	const float* middle = &history[((historyPos + combDelay) % (2 * combDelay)) * nChannels];
+	const float gain = (float)emphasisGain;
+	for (int c = 0; c < nChannels; c++) {
+		emphasized[c] = (frame[c] - 2.0f * middle[c] + oldest[c]) * gain;
+		oldest[c] = frame[c];
+	}
+	if (++historyPos == 2 * combDelay) {
+		historyPos = 0;
+	}
+	if (!demodulator.process(emphasized.data())) {
+		return false;
+	}
+	// sum w_t x_t with w_t = decay^-t is the exponentially forgotten sum, up to a common factor
+	scale /= decay;
+	if (scale > SCALE_LIMIT) {
+		double inverse = 1.0 / scale;
+		for (int i = 0; i < (int)amplitudeSum.size(); i++) {
+			amplitudeSum[i] *= inverse;
+			weightSum[i] *= inverse;
+		}
+		scale = 1;
+	}
+
+	const std::complex<double>* amplitude = demodulator.getOutput();
+	const std::complex<double> rotation = phaseOscillator * delayRotation;
+	for (int c = 0; c < nChannels; c++) {
+		double phase = std::arg(phaseBins[c] * rotation);
+		int bin = std::min((int)((phase + M_PI) * (PAC_BINS / (2.0 * M_PI))), PAC_BINS - 1);
+		amplitudeSum[c * PAC_BINS + bin] += scale * std::abs(amplitude[c]);
+		weightSum[c * PAC_BINS + bin] += scale;
+	}
+
+	if (++hops < warmupHops) {
+		return true;
+	}
+	// the index moves over a time constant, so a few hops of lag are free
+	std::fill(channelChanged.begin(), channelChanged.end(), 0);
+	for (int i = 0; i < std::min(PAC_BINS, nChannels); i++) {
+		const int c = nextChannel;
+		nextChannel = (nextChannel + 1 == nChannels) ? 0 : nextChannel + 1;
+		const uint8_t on = (threshold > 0) && (getModulationIndex(c) >= threshold);
+		channelChanged[c] = (on != channelOn[c]);
+		channelOn[c] = on;
+	}
+	return true;
+}
+
+int PhaseAmplitudeCoupling::getNumChannels() const
+{
+	return nChannels;
+}
+
+double PhaseAmplitudeCoupling::getModulationIndex(int channel) const
+{
+	// mean amplitude per phase bin as a distribution P; MI = (log N - H(P)) / log N
+	double mean[PAC_BINS];
+	double total = 0;
+	for (int b = 0; b < PAC_BINS; b++) {
+		double weight = weightSum[channel * PAC_BINS + b];
+		mean[b] = (weight > 0) ? amplitudeSum[channel * PAC_BINS + b] / weight : 0.0;
+		total += mean[b];
+	}
+	if (total <= 0) {
+		return 0;
+	}
+	double entropy = 0;
+	for (int b = 0; b < PAC_BINS; b++) {
+		if (mean[b] > 0) {
+			double p = mean[b] / total;
+			entropy -= p * std::log(p);
+		}
+	}
+	const double maxEntropy = std::log((double)PAC_BINS);
+	return (maxEntropy - entropy) / maxEntropy;
+}
+
+double PhaseAmplitudeCoupling::getPreferredPhase(int channel) const
+{
+	int best = 0;
+	double bestMean = -1;
+	for (int b = 0; b < PAC_BINS; b++) {
+		double weight = weightSum[channel * PAC_BINS + b];
+		double mean = (weight > 0) ? amplitudeSum[channel * PAC_BINS + b] / weight : 0.0;
+		if (mean > bestMean) {
+			bestMean = mean;
+			best = b;
+		}
+	}
+	return -M_PI + (best + 0.5) * (2.0 * M_PI / PAC_BINS);
+}
+
+bool PhaseAmplitudeCoupling::isChannelOn(int channel) const
+{
+	return channelOn[channel] != 0;
+}
+
+bool PhaseAmplitudeCoupling::hasChannelChanged(int channel) const
+{
+	return channelChanged[channel] != 0;
+}
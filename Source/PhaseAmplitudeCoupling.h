@@ -0,0 +1,68 @@
+#ifndef PHASEAMPLITUDECOUPLING_H
+#define PHASEAMPLITUDECOUPLING_H
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "ComplexDemodulator.h"
+
+
+/*
+ * Online phase-amplitude coupling of every selected channel. The amplitude
+ * band is complex demodulated here, once per hop; the phase comes from the
+ * detection band bins that ChannelVoting already keeps, turned forward to
+ * the time of the amplitude by the demodulator oscillator. The amplitude
+ * path goes through a squared comb (1 - z^-D)^2 first, with its first peak
+ * at the band centre and its zero at DC: the short CIC of a wide amplitude
+ * band lets the phase rhythm through otherwise, and that leak alone reads
+ * as coupling. Each hop adds
+ * the amplitude to one of PAC_BINS phase bins per channel, with exponential
+ * forgetting, and the modulation index is the normalized KL distance of the
+ * binned mean amplitude from uniform (Tort et al. 2010). Forgetting scales
+ * the new entries up instead of decaying the histogram, so a hop touches
+ * one bin per channel; the thresholds check PAC_BINS channels per hop in
+ * turn.
+ */
+class PhaseAmplitudeCoupling
+{
+public:
+	static constexpr int PAC_BINS = 18;
+
+	PhaseAmplitudeCoupling();
+
+	// amplitude band in Hz; phaseCenter is the centre of the phase band; the
+	// time constant in s; a channel is on while its modulation index is at
+	// or above threshold (0: never), after one time constant of hops
+	void setup(int nChannels, double sampleRate, double ampLow, double ampHigh, int hop,
+		double phaseCenter, double timeConstant, double threshold);
+	// the time constant and trigger alone, as in setup(); keeps the histograms,
+	// so it may be called between hops
+	void setTimeConstant(double timeConstant, double threshold);
+	void clear();
+
+	// one sample of every selected channel and the current phase band bins;
+	// true on a hop, when the indices are new
+	bool process(const float* frame, const std::complex<double>* phaseBins, std::complex<double> phaseOscillator);
+
+	int getNumChannels() const;
+	double getModulationIndex(int channel) const;
+	double getPreferredPhase(int channel) const;	// centre of the largest bin, radians
+	bool isChannelOn(int channel) const;
+	bool hasChannelChanged(int channel) const;	// on the last hop
+
+private:
+	int nChannels;
+	double hopRate, decay, threshold, emphasisGain;
+	int hops, warmupHops, nextChannel;
+	int combDelay, historyPos;
+	double scale;	// weight of the newest hop; older ones keep theirs
+	std::complex<double> delayRotation;	// phase band back over the amplitude delay
+
+	std::vector<float> emphasized, history;	// history: 2 combDelay frames
+	ComplexDemodulator demodulator;
+	std::vector<double> amplitudeSum, weightSum;	// channels x PAC_BINS
+	std::vector<uint8_t> channelOn, channelChanged;
+};
+
+#endif
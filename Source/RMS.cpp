@@ -1,36 +1,42 @@
 #include "utils.h"
+#include <algorithm>
 #include <complex>
 
 
 /* RMS */
 RMS::RMS(int nsamp) {
-	size = nsamp;
-	clear();
+	setSize(nsamp);
 }
 
 void RMS::setSize(int nsamp) {
-	size = nsamp;
+	size = std::max(nsamp, 1);
+	buffer.assign(size, 0.0);
 	clear();
 }
 
+int RMS::getSize() {
+	return size;
+}
+
 void RMS::addSample(double sample) {
-	/*
 	double sq = sample * sample;
 	ss = ss - buffer[index] + sq;
-	buffer.set(index, sq);
-	index = (index + 1) % size;
-	*/
-
+	buffer[index] = sq;
+	if (++index == size) {
+		index = 0;
+		ss = 0;
+		for (double s : buffer) {
+			ss += s;
+		}
+	}
 }
 
 double RMS::getRes() {
-	return sqrt(ss / size);
+	return sqrt(std::max(ss, 0.0) / size);
 }
 
 void RMS::clear() {
-	/*
-	buffer.clear();
-	buffer.insertMultiple(0, 0, size);
+	std::fill(buffer.begin(), buffer.end(), 0.0);
 	index = 0;
-	ss = 0;*/
-}
\ No newline at end of file
+	ss = 0;
+}
@@ -0,0 +1,57 @@
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* RealtimeConstantQ */
+RealtimeConstantQ::RealtimeConstantQ(int fmin, int fmax, int nfft, int sampleRate)
+{
+	type = SdftType::ConstantQ;
+	init(fmin, fmax, nfft, sampleRate);
+}
+
+void RealtimeConstantQ::init(int fmin, int fmax, int nfft, int sampleRate)
+{
+	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
+
+	const int cycles = std::max(min_idx, 1);
+	lags.resize(n);
+	gains.resize(n);
+	tails.resize(n);
+	for (int k = 0; k < n; k++) {
+		const int bin = min_idx + k;
+		int length = (bin > 0) ? (int)std::lround((double)nfft * cycles / bin) : nfft;
+		length = std::min(std::max(length, 1), nfft);
+		lags[k] = length;
+		gains[k] = (double)nfft / length;
+		// z^N, exactly 1 when the window holds a whole number of cycles
+		tails[k] = coefs[((long long)bin * length) % nfft];
+	}
+}
+
+void RealtimeConstantQ::addSample(double in_sample)
+{
+	// index holds x(t - nfft); x(t - N) sits N slots back from it
+	const std::complex<double>* w = coefs + min_idx;
+	for (int k = 0; k < n; k++) {
+		int oldest = index + nfft - lags[k];
+		if (oldest >= nfft) {
+			oldest -= nfft;
+		}
+		fftout[k] = w[k] * fftout[k] + gains[k] * (in_sample - tails[k] * sample[oldest]);
+	}
+	sample[index] = in_sample;
+	index = (index + 1) % nfft;
+}
+
+int RealtimeConstantQ::getWindowLength(int bin) const
+{
+	return lags[bin];
+}
+
+size_t RealtimeConstantQ::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT) +
+		lags.capacity() * sizeof(int) + gains.capacity() * sizeof(double) +
+		tails.capacity() * sizeof(std::complex<double>);
+}
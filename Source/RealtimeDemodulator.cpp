@@ -0,0 +1,77 @@
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+
+
+/* RealtimeDemodulator */
+RealtimeDemodulator::RealtimeDemodulator(int fmin, int fmax, int nfft, int sampleRate) : hop(1)
+{
+	type = SdftType::ComplexDemod;
+	init(fmin, fmax, nfft, sampleRate);
+}
+
+void RealtimeDemodulator::init(int fmin, int fmax, int nfft, int sampleRate)
+{
+	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
+
+	// one output, no input ring
+	n = 1;
+	n_out = 1;
+	steps.assign(1, 1);
+	fftout.assign(1, std::complex<double>(0));
+	sample.clear();
+	sample.shrink_to_fit();
+
+	// a second order CIC of length L is 3 dB down at about 0.32 rfs / L
+	double width = std::min(std::max((double)(fmax - fmin), rfs / nfft), 0.45 * rfs);
+	center = (fmin + fmax) / 2.0;
+	windowLength = std::max((int)std::lround(0.64 * rfs / width), 1);
+	setupDemodulator();
+}
+
+void RealtimeDemodulator::setupDemodulator()
+{
+	demodulator.setup(1, rfs, center, windowLength, hop);
+	std::fill(fftout.begin(), fftout.end(), std::complex<double>(0));
+}
+
+void RealtimeDemodulator::setHop(int hop)
+{
+	hop = std::max(hop, 1);
+	if (hop != this->hop) {
+		this->hop = hop;
+		setupDemodulator();
+	}
+}
+
+void RealtimeDemodulator::clear()
+{
+	RealtimeSDFT::clear();
+	demodulator.reset();
+}
+
+void RealtimeDemodulator::addSample(double in_sample)
+{
+	float x = (float)in_sample;
+	if (demodulator.process(&x)) {
+		// |X| / nfft of an SDFT reads amplitude / 2, as does the demodulator
+		fftout[0] = demodulator.getOutput()[0] * (double)nfft;
+	}
+}
+
+double RealtimeDemodulator::getEnvelope() const
+{
+	return 2.0 * std::abs(demodulator.getOutput()[0]);
+}
+
+double RealtimeDemodulator::getPhase() const
+{
+	return std::arg(demodulator.getOutput()[0] * demodulator.getOscillator());
+}
+
+size_t RealtimeDemodulator::getMemoryFootprint() const
+{
+	// the demodulator keeps 4 integrators and 4 comb delay lines per channel
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT) +
+		(4 + 4 * windowLength / hop) * sizeof(uint64_t) + sizeof(std::complex<double>);
+}
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include <algorithm>
 #include <iostream>
 
 RealtimeExpSDFT::RealtimeExpSDFT(int fmin, int fmax, int nfft, int sampleRate)
@@ -11,8 +12,10 @@ void RealtimeExpSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
 {
 	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
 
-	fftout1.resize(nfft, std::complex<double>(0));
-	fftout2.resize(nfft, std::complex<double>(0));
+	fftout1.assign(n, std::complex<double>(0));
+	fftout1.shrink_to_fit();
+	fftout2.assign(n, std::complex<double>(0));
+	fftout2.shrink_to_fit();
 
 	int D = 20;
 	double tau = nfft / 2.0 * 8.69 / D;
@@ -24,9 +27,12 @@ void RealtimeExpSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
 	change_label = true;	// 1
 	reset_count = 0;
 	if (reset_label) {
-		sample_2.resize(nfft, std::complex<double>(0));
-		fftout1_2.resize(nfft, std::complex<double>(0));
-		fftout2_2.resize(nfft, std::complex<double>(0));
+		sample_2.assign(nfft, 0.0);
+		sample_2.shrink_to_fit();
+		fftout1_2.assign(n, std::complex<double>(0));
+		fftout1_2.shrink_to_fit();
+		fftout2_2.assign(n, std::complex<double>(0));
+		fftout2_2.shrink_to_fit();
 	}
 }
 
@@ -36,87 +42,87 @@ void RealtimeExpSDFT::addSample(double in_sample) {
 		return;
 	}
 
-	std::complex<double> x_a1, x_aN_1;
+	double x_a1, x_aN_1;
 	x_a1 = sample[index];
 	x_aN_1 = in_sample;
-	std::complex<double> x_aN2 = sample[(index + nfft / 2 + 1) % nfft];
+	double x_aN2 = sample[(index + nfft / 2 + 1) % nfft];
 	sample[index] = x_aN_1;
 
-	for (int i = min_idx; i <= max_idx; i++) {
-		fftout1[i] = coefs[i] * (downTau * fftout1[i] - x_a1 * W_1);
-		fftout2[i] = coefs[i] * (upTau * fftout2[i] + x_aN_1 * W_2);
+	const std::complex<double>* w = coefs + min_idx;
+	for (int k = 0; k < n; k++) {
+		int i = min_idx + k;
+		fftout1[k] = w[k] * (downTau * fftout1[k] - x_a1 * W_1);
+		fftout2[k] = w[k] * (upTau * fftout2[k] + x_aN_1 * W_2);
 
-		fftout[i] = fftout1[i] + fftout2[i];
+		fftout[k] = fftout1[k] + fftout2[k];
 		if (i % 2) { // 
-			fftout1[i] -= x_aN2;
-			fftout2[i] += x_aN2;
+			fftout1[k] -= x_aN2;
+			fftout2[k] += x_aN2;
 		}
 		else {
-			fftout1[i] += x_aN2;
-			fftout2[i] -= x_aN2;
+			fftout1[k] += x_aN2;
+			fftout2[k] -= x_aN2;
 		}
-		fftout[i] = fftout1[i] + fftout2[i];
+		fftout[k] = fftout1[k] + fftout2[k];
 	}
 	index = (index + 1) % nfft;
 }
 
-void RealtimeExpSDFT::addSampleReset(std::complex<double> in_sample) {
+void RealtimeExpSDFT::addSampleReset(double in_sample) {
 	reset_count++;
 	if (reset_count > nfft * 3) {
 		// std::cout << "change\n";
 		if (change_label) { // 1 -> 2
 			// fftout1_2.clear();
 			// fftout1_2.resize(nfft, std::complex<double>(0));
-			fftout2_2.clear();
-			fftout2_2.resize(nfft, std::complex<double>(0));
-			sample_2.clear();
-			sample_2.resize(nfft, std::complex<double>(0));
+			std::fill(fftout2_2.begin(), fftout2_2.end(), std::complex<double>(0));
+			std::fill(sample_2.begin(), sample_2.end(), 0.0);
 		}
 		else { // 2 -> 1
 			// fftout1.clear();
 			// fftout1.resize(nfft, std::complex<double>(0));
-			fftout2.clear();
-			fftout2.resize(nfft, std::complex<double>(0));
-			sample.clear();
-			sample.resize(nfft, std::complex<double>(0));
+			std::fill(fftout2.begin(), fftout2.end(), std::complex<double>(0));
+			std::fill(sample.begin(), sample.end(), 0.0);
 		}
 		change_label = !change_label;
 		reset_count = 0;
 	}
 
-	std::complex<double> x_a1, x_a1_2;
+	double x_a1, x_a1_2;
 	x_a1 = sample[index];
 	x_a1_2 = sample_2[index];
 
-	std::complex<double> x_aN2 = sample[(index + nfft / 2 + 1) % nfft];
-	std::complex<double> x_aN2_2 = sample_2[(index + nfft / 2 + 1) % nfft];
+	double x_aN2 = sample[(index + nfft / 2 + 1) % nfft];
+	double x_aN2_2 = sample_2[(index + nfft / 2 + 1) % nfft];
 	sample[index] = in_sample;
 	sample_2[index] = in_sample;
 
-	for (int i = min_idx; i <= max_idx; i++) {
-		fftout1[i] = coefs[i] * (downTau * fftout1[i] - x_a1 * W_1);
-		fftout1_2[i] = coefs[i] * (downTau * fftout1_2[i] - x_a1_2 * W_1);
-		fftout2[i] = coefs[i] * (upTau * fftout2[i] + in_sample * W_2);
-		fftout2_2[i] = coefs[i] * (upTau * fftout2_2[i] + in_sample * W_2);
+	const std::complex<double>* w = coefs + min_idx;
+	for (int k = 0; k < n; k++) {
+		int i = min_idx + k;
+		fftout1[k] = w[k] * (downTau * fftout1[k] - x_a1 * W_1);
+		fftout1_2[k] = w[k] * (downTau * fftout1_2[k] - x_a1_2 * W_1);
+		fftout2[k] = w[k] * (upTau * fftout2[k] + in_sample * W_2);
+		fftout2_2[k] = w[k] * (upTau * fftout2_2[k] + in_sample * W_2);
 
 		if (i % 2) { // 
-			fftout1[i] -= x_aN2;
-			fftout1_2[i] -= x_aN2_2;
-			fftout2[i] += x_aN2;
-			fftout2_2[i] += x_aN2_2;
+			fftout1[k] -= x_aN2;
+			fftout1_2[k] -= x_aN2_2;
+			fftout2[k] += x_aN2;
+			fftout2_2[k] += x_aN2_2;
 		}
 		else {
-			fftout1[i] += x_aN2;
-			fftout1_2[i] += x_aN2_2;
-			fftout2[i] -= x_aN2;
-			fftout2_2[i] -= x_aN2_2;
+			fftout1[k] += x_aN2;
+			fftout1_2[k] += x_aN2_2;
+			fftout2[k] -= x_aN2;
+			fftout2_2[k] -= x_aN2_2;
 		}
 
 		if (change_label) {
-			fftout[i] = fftout1_2[i] + fftout2_2[i];
+			fftout[k] = fftout1_2[k] + fftout2_2[k];
 		}
 		else {
-			fftout[i] = fftout1[i] + fftout2[i];
+			fftout[k] = fftout1[k] + fftout2[k];
 		}
 	}
 	index = (index + 1) % nfft;
@@ -126,28 +132,28 @@ double RealtimeExpSDFT::getFFTout1() {
 	// int imin = fmin * nfft / rfs + 1;
 	// int imax = fmax * nfft / rfs;
 	double power = 0;
-	for (int i = min_idx; i <= max_idx; i++) {
-		std::complex<double> v = fftout1[i];
+	for (int k = 0; k < n; k++) {
+		std::complex<double> v = fftout1[k];
 		power += std::pow(v.real(), 2) + std::pow(v.imag(), 2);
 	}
-	return power / (max_idx - min_idx + 1) / nfft;
+	return power / n / nfft;
 }
 
 double RealtimeExpSDFT::getFFTout2() {
 	// int imin = fmin * nfft / rfs + 1;
 	// int imax = fmax * nfft / rfs;
 	double power = 0;
-	for (int i = min_idx; i <= max_idx; i++) {
+	for (int k = 0; k < n; k++) {
 		std::complex<double> v;
 		if (reset_label && !change_label) {
-			v = fftout2_2[i];
+			v = fftout2_2[k];
 		}
 		else {
-			v = fftout2[i];
+			v = fftout2[k];
 		}
 		power += std::pow(v.real(), 2) + std::pow(v.imag(), 2);
 	}
-	return power / (max_idx - min_idx + 1) / nfft;
+	return power / n / nfft;
 }
 
 void RealtimeExpSDFT::setNfft(int SDFT_nfft)
@@ -169,3 +175,10 @@ void RealtimeExpSDFT::clear()
 {
 	init(fmin, fmax, nfft, rfs);
 }
+
+size_t RealtimeExpSDFT::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT) +
+		sample_2.capacity() * sizeof(double) +
+		(fftout1.capacity() + fftout2.capacity() + fftout1_2.capacity() + fftout2_2.capacity()) * sizeof(std::complex<double>);
+}
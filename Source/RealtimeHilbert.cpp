@@ -0,0 +1,92 @@
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+
+// squared all-pass coefficients of a 90 degree phase difference network
+// (two chains of 4 second order sections in z^-2, about +-0.7 degrees
+// from 0.0005 to 0.4995 of the sample rate)
+static const double REAL_PATH[] = {
+	0.6923878 * 0.6923878, 0.9360654322959 * 0.9360654322959,
+	0.9882295226860 * 0.9882295226860, 0.9987488452737 * 0.9987488452737 };
+static const double IMAG_PATH[] = {
+	0.4021921162426 * 0.4021921162426, 0.8561710882420 * 0.8561710882420,
+	0.9722909545651 * 0.9722909545651, 0.9952884791278 * 0.9952884791278 };
+
+
+/* RealtimeHilbert */
+RealtimeHilbert::RealtimeHilbert(int fmin, int fmax, int nfft, int sampleRate)
+{
+	type = SdftType::HilbertEnvelope;
+	init(fmin, fmax, nfft, sampleRate);
+}
+
+void RealtimeHilbert::init(int fmin, int fmax, int nfft, int sampleRate)
+{
+	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
+
+	// one output, no input ring
+	n = 1;
+	n_out = 1;
+	steps.assign(1, 1);
+	fftout.assign(1, std::complex<double>(0));
+	sample.clear();
+	sample.shrink_to_fit();
+
+	// keep both band edges strictly between 0 and Nyquist
+	double width = std::min(std::max((double)(fmax - fmin), rfs / nfft), 0.45 * rfs);
+	double center = (fmin + fmax) / 2.0;
+	center = std::min(std::max(center, 0.55 * width), 0.5 * rfs - 0.55 * width);
+	bandpass.setup(rfs, center, width);
+	clear();
+}
+
+void RealtimeHilbert::clear()
+{
+	RealtimeSDFT::clear();
+	bandpass.reset();
+	std::fill(std::begin(realPath), std::end(realPath), AllpassState{ 0, 0, 0, 0 });
+	std::fill(std::begin(imagPath), std::end(imagPath), AllpassState{ 0, 0, 0, 0 });
+	realDelay = 0;
+	analytic = 0;
+}
+
+double RealtimeHilbert::allpassChain(const double* coefficients, AllpassState* states, double x)
+{
+	// y[n] = a^2 (x[n] + y[n-2]) - x[n-2] per section
+	for (int i = 0; i < ALLPASS_STAGES; i++) {
+		AllpassState& s = states[i];
+		double y = coefficients[i] * (x + s.y2) - s.x2;
+		s.x2 = s.x1;
+		s.x1 = x;
+		s.y2 = s.y1;
+		s.y1 = y;
+		x = y;
+	}
+	return x;
+}
+
+void RealtimeHilbert::addSample(double in_sample)
+{
+	double x = bandpass.filter(in_sample);
+	double re = allpassChain(REAL_PATH, realPath, x);
+	double im = allpassChain(IMAG_PATH, imagPath, x);
+	analytic = std::complex<double>(realDelay, -im);
+	realDelay = re;
+	// |X| / nfft of an SDFT reads amplitude / 2 for a sinusoid
+	fftout[0] = analytic * (nfft / 2.0);
+}
+
+double RealtimeHilbert::getEnvelope() const
+{
+	return std::abs(analytic);
+}
+
+double RealtimeHilbert::getPhase() const
+{
+	return std::arg(analytic);
+}
+
+size_t RealtimeHilbert::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT);
+}
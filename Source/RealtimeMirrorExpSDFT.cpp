@@ -11,8 +11,10 @@ void RealtimeMirrorExpSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
 {
 	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
 
-	fftout1.resize(nfft, std::complex<double>(0));
-	fftout2.resize(nfft, std::complex<double>(0));
+	fftout1.assign(n, std::complex<double>(0));
+	fftout1.shrink_to_fit();
+	fftout2.assign(n, std::complex<double>(0));
+	fftout2.shrink_to_fit();
 
 	int D = 20;
 	double tau = nfft / 2.0 * 8.69 / D;
@@ -20,28 +22,25 @@ void RealtimeMirrorExpSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
 	tau_down = exp(-1 / tau);
 	N2tau = exp(-(nfft / 2.0 / tau));
 
-	coefs1.resize(nfft);
-	coefs2.resize(nfft);
-	for (int i = 0; i < nfft; i++) {
-		coefs1[i] = std::complex<double>(std::cos(2 * M_PI * i / nfft), std::sin(2 * M_PI * i / nfft));
-		coefs2[i] = std::complex<double>(std::cos(2 * M_PI * i / nfft), std::sin(-2 * M_PI * i / nfft));
-	}
 	PoolLength = nfft / 2 + 1;
+	sample.assign(PoolLength, 0.0);
+	sample.shrink_to_fit();
 }
 
 void RealtimeMirrorExpSDFT::addSample(double in_sample) {
-	std::complex<double> sample_Prev, sampleOld, sampleOldPrev;
+	double sample_Prev, sampleOld, sampleOldPrev;
 
 	// asumming
 	sample_Prev = sample[(index - 1 + PoolLength) % PoolLength];	// x(a+N/2)
 	sampleOldPrev = sample[index];	// x(a)
 	sampleOld = sample[(index + 1) % PoolLength];	// x(a+1)
 
-	for (int i = min_idx; i <= max_idx; i++) {
-		double AltSign = (i % 2 == 0) ? 1 : -1;
-		fftout1[i] = (fftout1[i] + sample_Prev * AltSign - sampleOldPrev * N2tau) * tau_down * coefs1[i];
-		fftout2[i] = fftout2[i] * tau_down * coefs2[i] + in_sample * AltSign - sampleOld * N2tau;
-		fftout[i] = fftout1[i] + fftout2[i];
+	const std::complex<double>* w = coefs + min_idx;
+	for (int k = 0; k < n; k++) {
+		double AltSign = ((min_idx + k) % 2 == 0) ? 1 : -1;
+		fftout1[k] = (fftout1[k] + sample_Prev * AltSign - sampleOldPrev * N2tau) * tau_down * w[k];
+		fftout2[k] = fftout2[k] * tau_down * std::conj(w[k]) + in_sample * AltSign - sampleOld * N2tau;
+		fftout[k] = fftout1[k] + fftout2[k];
 	}
 
 	sample[index] = in_sample;
@@ -66,4 +65,10 @@ void RealtimeMirrorExpSDFT::setFreqs(int FreqMin, int FreqMax)
 void RealtimeMirrorExpSDFT::setSampleRate(int samplerate)
 {
 	init(fmin, fmax, nfft, samplerate);
-}
\ No newline at end of file
+}
+
+size_t RealtimeMirrorExpSDFT::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT) +
+		(fftout1.capacity() + fftout2.capacity()) * sizeof(std::complex<double>);
+}
@@ -0,0 +1,91 @@
+#include "utils.h"
+#include "iir/Simd.h"
+#include <algorithm>
+
+
+// X = z X + gain x - tail old over the bins of every window; complex values
+// as interleaved re, im pairs so the bin loop vectorizes
+IIR_SIMD_CLONES
+static void updateWindows(double* IIR_RESTRICT bins, const double* IIR_RESTRICT rotations,
+	const double* IIR_RESTRICT tails, const double* drives, const double* oldest, int windows, int n)
+{
+	for (int j = 0; j < windows; j++) {
+		double* IIR_RESTRICT x = bins + 2 * j * n;
+		const double* IIR_RESTRICT t = tails + 2 * j * n;
+		const double drive = drives[j], old = oldest[j];
+		for (int k = 0; k < n; k++) {
+			const double re = x[2 * k], im = x[2 * k + 1];
+			const double wr = rotations[2 * k], wi = rotations[2 * k + 1];
+			x[2 * k] = wr * re - wi * im + drive - t[2 * k] * old;
+			x[2 * k + 1] = wr * im + wi * re - t[2 * k + 1] * old;
+		}
+	}
+}
+
+
+/* RealtimeMultiWindowSDFT */
+RealtimeMultiWindowSDFT::RealtimeMultiWindowSDFT(int fmin, int fmax, int nfft, int sampleRate)
+{
+	type = SdftType::MultiWindow;
+	init(fmin, fmax, nfft, sampleRate);
+}
+
+void RealtimeMultiWindowSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
+{
+	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
+
+	// the base class lays out one window; repeat its bins and bands for the others
+	bins = n;
+	const int bands = n_out;
+	n = WINDOWS * bins;
+	n_out = WINDOWS * bands;
+	steps.resize(n_out);
+	for (int i = bands; i < n_out; i++) {
+		steps[i] = steps[i % bands];
+	}
+	fftout.assign(n, std::complex<double>(0));
+	fftout.shrink_to_fit();
+
+	lags.resize(WINDOWS);
+	gains.resize(WINDOWS);
+	tails.resize(n);
+	for (int j = 0; j < WINDOWS; j++) {
+		const int length = std::max(nfft >> j, 1);
+		lags[j] = length;
+		gains[j] = (double)nfft / length;
+		for (int k = 0; k < bins; k++) {
+			// gain z^N, the gain alone when the window holds a whole number of cycles
+			tails[j * bins + k] = gains[j] * coefs[((long long)(min_idx + k) * length) % nfft];
+		}
+	}
+}
+
+void RealtimeMultiWindowSDFT::addSample(double in_sample)
+{
+	// index holds x(t - nfft); x(t - N) sits N slots back from it
+	double drives[WINDOWS], oldest[WINDOWS];
+	for (int j = 0; j < WINDOWS; j++) {
+		int slot = index + nfft - lags[j];
+		if (slot >= nfft) {
+			slot -= nfft;
+		}
+		drives[j] = gains[j] * in_sample;
+		oldest[j] = sample[slot];
+	}
+	updateWindows(reinterpret_cast<double*>(fftout.data()), reinterpret_cast<const double*>(coefs + min_idx),
+		reinterpret_cast<const double*>(tails.data()), drives, oldest, WINDOWS, bins);
+	sample[index] = in_sample;
+	index = (index + 1) % nfft;
+}
+
+int RealtimeMultiWindowSDFT::getWindowLength(int window) const
+{
+	return lags[window];
+}
+
+size_t RealtimeMultiWindowSDFT::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT) +
+		lags.capacity() * sizeof(int) + gains.capacity() * sizeof(double) +
+		tails.capacity() * sizeof(std::complex<double>);
+}
@@ -1,10 +1,11 @@
 #include "utils.h"
+#include <algorithm>
 #include <iostream>
 
 
 
 /* RealtimeSDFT */
-RealtimeSDFT::RealtimeSDFT(int fmin, int fmax, int nfft, int sampleRate) : nfft(nfft), rfs(sampleRate), fmin(fmin), fmax(fmax) {
+RealtimeSDFT::RealtimeSDFT(int fmin, int fmax, int nfft, int sampleRate) : nfft(nfft), rfs(sampleRate), fmin(fmin), fmax(fmax), coefs(nullptr) {
 	type = SdftType::RECTANGLE;
 	init(fmin, fmax, nfft, sampleRate);
 }
@@ -16,8 +17,9 @@ void RealtimeSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
 	this->fmin = fmin;
 	this->fmax = fmax;
 	rfs = sampleRate;
-	max_idx = std::min((fmax * nfft) / (int)rfs, nfft);
+	max_idx = std::min((fmax * nfft) / (int)rfs, nfft - 1);
 	min_idx = std::max((fmin * nfft) / (int)rfs, 0);
+	max_idx = std::max(max_idx, min_idx);
 	n = max_idx - min_idx + 1;
 	n_out = std::min(n, 5);
 	steps.resize(n_out, n/n_out);
@@ -26,13 +28,24 @@ void RealtimeSDFT::init(int fmin, int fmax, int nfft, int sampleRate)
 		steps[i] = steps[i] + 1;
 	}
 
-	coefs.resize(nfft);
-	for (int i = 0; i < nfft; i++) {
-		coefs[i] = std::complex<double>(std::cos(2 * M_PI * i / nfft), std::sin(2 * M_PI * i / nfft));
+	if (!twiddles || (int)twiddles->size() != nfft) {
+		twiddles = TwiddleCache::get(nfft);
+		coefs = twiddles->data();
 	}
 	index = 0;
-	sample.resize(nfft, std::complex<double>(0));
-	fftout.resize(nfft, std::complex<double>(0));
+	sample.assign(nfft, 0.0);
+	sample.shrink_to_fit();
+	fftout.assign(n, std::complex<double>(0));
+	fftout.shrink_to_fit();
+}
+
+void RealtimeSDFT::configure(int fmin, int fmax, int nfft, int sampleRate)
+{
+	// called on every parameter change, most of which do not touch the transform
+	if (fmin == this->fmin && fmax == this->fmax && nfft == this->nfft && sampleRate == (int)rfs) {
+		return;
+	}
+	init(fmin, fmax, nfft, sampleRate);
 }
 
 void RealtimeSDFT::setNfft(int SDFT_nfft)
@@ -52,15 +65,16 @@ void RealtimeSDFT::setSampleRate(int samplerate)
 
 void RealtimeSDFT::clear() {
 	index = 0;
-	sample.assign(nfft, std::complex<double>(0));
-	fftout.assign(nfft, std::complex<double>(0));
+	std::fill(sample.begin(), sample.end(), 0.0);
+	std::fill(fftout.begin(), fftout.end(), std::complex<double>(0));
 }
 
 void RealtimeSDFT::addSample(double in_sample) {
-	std::complex<double> delta = in_sample - sample[index];
+	double delta = in_sample - sample[index];
 	sample[index] = in_sample;
-	for (int i = min_idx; i <= max_idx; i++) {
-		fftout[i] = (fftout[i] + delta) * coefs[i];
+	const std::complex<double>* w = coefs + min_idx;
+	for (int k = 0; k < n; k++) {
+		fftout[k] = (fftout[k] + delta) * w[k];
 	}
 	index = (index + 1) % nfft;
 }
@@ -69,10 +83,16 @@ double RealtimeSDFT::getBandPower() {
 	// int imin = fmin * nfft / rfs + 1;
 	// int imax = fmax * nfft / rfs;
 	double power = 0;
-	for (int i = min_idx; i <= max_idx; i++) {
-		power += std::abs(fftout[i]);
+	if (powerDomain) {
+		for (int k = 0; k < n; k++) {
+			power += std::norm(fftout[k]);
+		}
+		return power / n / ((double)nfft * nfft);
+	}
+	for (int k = 0; k < n; k++) {
+		power += std::abs(fftout[k]);
 	}
-	return power / (max_idx - min_idx + 1) / nfft;
+	return power / n / nfft;
 }
 
 std::vector<double> RealtimeSDFT::getBandPowerList()
@@ -86,7 +106,26 @@ std::vector<double> RealtimeSDFT::getBandPowerList()
 	return powers;
 	*/
 	std::vector<double> powers(n_out, 0);
-	int index = min_idx;
+	getBandPowerList(powers);
+	return powers;
+}
+
+void RealtimeSDFT::getBandPowerList(std::vector<double>& powers)
+{
+	powers.resize(n_out);
+	int index = 0;
+	if (powerDomain) {
+		const double scale = 1.0 / ((double)nfft * nfft);
+		for (int i = 0; i < n_out; i++) {
+			double out = 0;
+			for (int j = 0; j < steps[i]; j++) {
+				out += std::norm(fftout[index]);
+				index++;
+			}
+			powers[i] = out * scale / steps[i];
+		}
+		return;
+	}
 	for (int i = 0; i < n_out; i++) {
 		double out = 0;
 		for (int j = 0; j < steps[i]; j++) {
@@ -95,10 +134,24 @@ std::vector<double> RealtimeSDFT::getBandPowerList()
 		}
 		powers[i] = out / nfft / steps[i];
 	}
-	return powers;
+}
+
+void RealtimeSDFT::setPowerDomain(bool powerDomain)
+{
+	this->powerDomain = powerDomain;
+}
+
+void RealtimeSDFT::setHop(int)
+{
 }
 
 int RealtimeSDFT::get_n()
 {
 	return n_out;
 }
+
+size_t RealtimeSDFT::getMemoryFootprint() const
+{
+	return sizeof(RealtimeSDFT) + sample.capacity() * sizeof(double) +
+		fftout.capacity() * sizeof(std::complex<double>) + steps.capacity() * sizeof(int);
+}
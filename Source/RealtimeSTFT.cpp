@@ -0,0 +1,121 @@
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+/* RealtimeSTFT */
+RealtimeSTFT::RealtimeSTFT(int fmin, int fmax, int nfft, int sampleRate) : hop(1), hopCount(0)
+{
+	type = SdftType::HoppedSTFT;
+	init(fmin, fmax, nfft, sampleRate);
+}
+
+void RealtimeSTFT::init(int fmin, int fmax, int nfft, int sampleRate)
+{
+	RealtimeSDFT::init(fmin, fmax, nfft, sampleRate);
+
+	// periodic Hann scaled to a mean of 1, so a sinusoid reads the same band power
+	// as on the rectangular SDFT
+	window.resize(nfft);
+	for (int i = 0; i < nfft; i++) {
+		window[i] = 1.0 - std::cos(2.0 * M_PI * i / nfft);
+	}
+	frame.assign(nfft, 0.0);
+	dft.setup(nfft, min_idx, max_idx);
+	hopCount = 0;
+}
+
+void RealtimeSTFT::setHop(int hop)
+{
+	this->hop = std::max(hop, 0);
+	hopCount = 0;
+}
+
+void RealtimeSTFT::clear()
+{
+	RealtimeSDFT::clear();
+	hopCount = 0;
+}
+
+void RealtimeSTFT::addSample(double in_sample)
+{
+	sample[index] = in_sample;
+	index = (index + 1) % nfft;
+	if (hop > 0 && ++hopCount >= hop) {
+		hopCount = 0;
+		transform();
+	}
+}
+
+void RealtimeSTFT::transform()
+{
+	// oldest sample first
+	const int head = nfft - index;
+	for (int i = 0; i < head; i++) {
+		frame[i] = sample[index + i] * window[i];
+	}
+	for (int i = head; i < nfft; i++) {
+		frame[i] = sample[i - head] * window[i];
+	}
+	dft.transform(frame.data(), fftout.data());
+}
+
+double RealtimeSTFT::getFrameRms() const
+{
+	// by Parseval the energy of the windowed frame is that of its spectrum
+	double ss = 0;
+	for (int i = 0; i < nfft; i++) {
+		ss += frame[i] * frame[i];
+	}
+	return std::sqrt(ss / nfft);
+}
+
+size_t RealtimeSTFT::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT) +
+		(window.capacity() + frame.capacity()) * sizeof(double);
+}
+
+
+double estimateEngineCost(SdftType type, int fmin, int fmax, int nfft, int sampleRate, int hop)
+{
+	int max_idx = std::min((fmax * nfft) / sampleRate, nfft - 1);
+	int min_idx = std::max((fmin * nfft) / sampleRate, 0);
+	max_idx = std::max(max_idx, min_idx);
+	const int n = max_idx - min_idx + 1;
+	hop = std::max(hop, 1);
+
+	// per-bin weights are flop equivalents of the measured update loops (x86-64, -O3);
+	// |X| per bin is read once per hop
+	double cost = n * 20.0 / hop;
+	switch (type) {
+	case SdftType::RECTANGLE:
+		return cost + n * 8.0;
+	case SdftType::EXP:
+		return cost + n * 28.0;
+	case SdftType::ZeroPaddingExp:
+		return cost + n * 5.0;
+	case SdftType::MirrorExp:
+		return cost + n * 10.0;
+	case SdftType::ConstantQ:
+		return cost + n * 12.0;
+	case SdftType::MultiWindow:
+		// every window is a constant-Q pass over the band with one lag
+		return RealtimeMultiWindowSDFT::WINDOWS * (cost + n * 10.0);
+	case SdftType::HilbertEnvelope:
+		// 2 biquads, 8 all-pass sections, one output
+		return 20.0 / hop + 40.0;
+	case SdftType::ComplexDemod:
+		// mix, quantize and two complex integrators per sample, two combs per hop
+		return (20.0 + 8.0) / hop + 14.0;
+	case SdftType::HoppedSTFT:
+		// window the ring, then the pruned transform
+		return cost + (2.0 * nfft + PrunedRealDFT::estimateCost(nfft, min_idx, max_idx)) / hop;
+	default:
+		return cost;
+	}
+}
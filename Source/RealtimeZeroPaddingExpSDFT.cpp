@@ -19,19 +19,27 @@ void RealtimeZeroPaddingExpSDFT::init(int fmin, int fmax, int nfft, int sampleRa
 	N2tau = exp(-(nfft / 2.0 / tau));
 
 	PoolLength = nfft / 2 + 1;
+	sample.assign(PoolLength, 0.0);
+	sample.shrink_to_fit();
 }
 
 void RealtimeZeroPaddingExpSDFT::addSample(double in_sample) {
-	std::complex<double> sampleOldPrev;
+	double sampleOldPrev;
 
 	sampleOldPrev = sample[index];	// x(a)
 
+	const std::complex<double>* w = coefs + min_idx;
 	double AltSign = (min_idx % 2 == 0) ? 1 : -1;
-	for (int i = min_idx; i <= max_idx; i++) {
-		fftout[i] = (fftout[i] - sampleOldPrev * N2tau) * tau_down * coefs[i] + in_sample * AltSign;
+	for (int k = 0; k < n; k++) {
+		fftout[k] = (fftout[k] - sampleOldPrev * N2tau) * tau_down * w[k] + in_sample * AltSign;
 		AltSign = -AltSign;
 	}
 
 	sample[index] = in_sample;
 	index = (index + 1) % PoolLength;
 }
+
+size_t RealtimeZeroPaddingExpSDFT::getMemoryFootprint() const
+{
+	return RealtimeSDFT::getMemoryFootprint() + sizeof(*this) - sizeof(RealtimeSDFT);
+}
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include <algorithm>
 
 SlidingWindow::SlidingWindow() : window_size_(600), sum_(0.0), index_(0)
 {
@@ -15,13 +16,15 @@ double SlidingWindow::addSample(double in_sample)
 
 void SlidingWindow::setWindowSize(size_t window_size)
 {
-	buffer_.resize(window_size_, 0.0);
 	window_size_ = window_size;
+	buffer_.resize(window_size_, 0.0);
 	clear();
 }
 
 void SlidingWindow::clear()
 {
+	// the running sum must match the buffer, or the average stays offset
+	std::fill(buffer_.begin(), buffer_.end(), 0.0);
 	sum_ = 0;
 	index_ = 0;
 }
@@ -0,0 +1,205 @@
+#include "utils.h"
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+
+
+/* SpatialFilter */
+SpatialFilter::SpatialFilter() : reference(SpatialReference::NO_REFERENCE), nOutputs(1), capacity(0)
+{
+	updateWeights();
+}
+
+void SpatialFilter::setChannels(const std::vector<int>& channels)
+{
+	this->channels = channels;
+	medianScratch.resize(channels.size());
+	updateWeights();
+}
+
+void SpatialFilter::setReference(SpatialReference reference)
+{
+	this->reference = reference;
+}
+
+void SpatialFilter::setWeights(const std::vector<std::vector<float>>& weights)
+{
+	requestedWeights = weights;
+	updateWeights();
+}
+
+void SpatialFilter::setWeightRow(int k, const std::vector<float>& row)
+{
+	// in-place update for weights published while running, no reallocation
+	int nChannels = (int)channels.size();
+	if (k >= nOutputs || (int)row.size() != nChannels) {
+		return;
+	}
+	std::copy(row.begin(), row.end(), weights.begin() + k * nChannels);
+	weightSums[k] = 0.0f;
+	for (int j = 0; j < nChannels; j++) {
+		weightSums[k] += row[j];
+	}
+}
+
+std::vector<std::vector<float>> SpatialFilter::parseWeights(const std::string& text)
+{
+	// "w00,w01,...;w10,w11,..." -> one row per virtual channel
+	std::vector<std::vector<float>> rows;
+	std::stringstream rowStream(text);
+	std::string row;
+	while (std::getline(rowStream, row, ';')) {
+		std::vector<float> values;
+		std::stringstream valueStream(row);
+		std::string value;
+		while (std::getline(valueStream, value, ',')) {
+			try {
+				values.push_back(std::stof(value));
+			}
+			catch (const std::logic_error&) {
+				std::cout << "[Error] Invalid spatial weight: " << value << std::endl;
+				return {};
+			}
+		}
+		if (!values.empty()) {
+			rows.push_back(values);
+		}
+	}
+	return rows;
+}
+
+void SpatialFilter::updateWeights()
+{
+	int nChannels = (int)channels.size();
+	bool valid = !requestedWeights.empty();
+	for (const auto& row : requestedWeights) {
+		valid = valid && ((int)row.size() == nChannels);
+	}
+	if (!requestedWeights.empty() && !valid) {
+		std::cout << "[Error] Spatial weights do not match the " << nChannels
+			<< " selected channels, using the channel mean" << std::endl;
+	}
+
+	if (valid) {
+		nOutputs = (int)requestedWeights.size();
+		weights.resize(nOutputs * nChannels);
+		for (int k = 0; k < nOutputs; k++) {
+			std::copy(requestedWeights[k].begin(), requestedWeights[k].end(), weights.begin() + k * nChannels);
+		}
+	}
+	else {
+		nOutputs = 1;
+		weights.assign(nChannels, nChannels > 0 ? 1.0f / nChannels : 0.0f);
+	}
+
+	weightSums.assign(nOutputs, 0.0f);
+	for (int k = 0; k < nOutputs; k++) {
+		for (int j = 0; j < nChannels; j++) {
+			weightSums[k] += weights[k * nChannels + j];
+		}
+	}
+	output.assign(nOutputs * capacity, 0.0f);
+}
+
+void SpatialFilter::computeReference(const float** data, int start, int n, int step)
+{
+	int nChannels = (int)channels.size();
+	float* ref = referenceBuffer.data();
+	std::fill(ref, ref + n, 0.0f);
+
+	if (reference == SpatialReference::CAR) {
+		const float scale = 1.0f / nChannels;
+		for (int j = 0; j < nChannels; j++) {
+			const float* x = data[channels[j]] + start;
+			if (step == 1) {
+				for (int k = 0; k < n; k++) ref[k] += x[k];
+			}
+			else {
+				for (int k = 0; k < n; k++) ref[k] += x[k * step];
+			}
+		}
+		for (int k = 0; k < n; k++) ref[k] *= scale;
+	}
+	else if (reference == SpatialReference::CMR) {
+		// the median needs every channel of one sample, so this is the only sample-major loop
+		const int mid = nChannels / 2;
+		for (int k = 0; k < n; k++) {
+			const int offset = start + k * step;
+			for (int j = 0; j < nChannels; j++) {
+				medianScratch[j] = data[channels[j]][offset];
+			}
+			std::nth_element(medianScratch.begin(), medianScratch.begin() + mid, medianScratch.end());
+			float median = medianScratch[mid];
+			if (nChannels % 2 == 0) {
+				median = 0.5f * (median + *std::max_element(medianScratch.begin(), medianScratch.begin() + mid));
+			}
+			ref[k] = median;
+		}
+	}
+}
+
+int SpatialFilter::process(const float** data, int start, int nSamples, int step)
+{
+	int n = (start < nSamples) ? (nSamples - start + step - 1) / step : 0;
+	if (n > capacity) {
+		capacity = n;
+		output.assign(nOutputs * capacity, 0.0f);
+		referenceBuffer.resize(capacity);
+	}
+
+	int nChannels = (int)channels.size();
+	for (int k = 0; k < nOutputs; k++) {
+		std::fill(output.begin() + k * capacity, output.begin() + k * capacity + n, 0.0f);
+	}
+	if (n == 0 || nChannels == 0) {
+		return n;
+	}
+
+	// small matrix-block multiply: every input row is streamed once for all outputs
+	for (int j = 0; j < nChannels; j++) {
+		const float* x = data[channels[j]] + start;
+		for (int k = 0; k < nOutputs; k++) {
+			const float w = weights[k * nChannels + j];
+			if (w == 0.0f) continue;
+			float* y = output.data() + k * capacity;
+			if (step == 1) {
+				for (int i = 0; i < n; i++) y[i] += w * x[i];
+			}
+			else {
+				for (int i = 0; i < n; i++) y[i] += w * x[i * step];
+			}
+		}
+	}
+
+	// sum_j w_j (x_j - ref) == sum_j w_j x_j - ref * sum_j w_j
+	if (reference != SpatialReference::NO_REFERENCE) {
+		computeReference(data, start, n, step);
+		const float* ref = referenceBuffer.data();
+		for (int k = 0; k < nOutputs; k++) {
+			const float wsum = weightSums[k];
+			float* y = output.data() + k * capacity;
+			for (int i = 0; i < n; i++) y[i] -= wsum * ref[i];
+		}
+	}
+	return n;
+}
+
+const float* SpatialFilter::getOutput(int k) const
+{
+	return output.data() + k * capacity;
+}
+
+const float* SpatialFilter::getReference() const
+{
+	return (reference != SpatialReference::NO_REFERENCE) ? referenceBuffer.data() : nullptr;
+}
+
+int SpatialFilter::getNumOutputs() const
+{
+	return nOutputs;
+}
+
+int SpatialFilter::getNumChannels() const
+{
+	return (int)channels.size();
+}
@@ -1,13 +1,25 @@
 #include "SwitchController.h"
+#include "iir/Simd.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
+static const int CUSUM_MIN_BASELINE = 20;       // hops of log band power before the CUSUM may fire
+static const double CUSUM_MAX_CORRELATION = 0.99; // keeps some evidence in every hop
+static const double CUSUM_MIN_SEPARATION = 0.5; // baseline standard deviations between baseline and threshold
+static const double CUSUM_FLOOR = 1e-12;        // log of zero power
+
 
 SwitchController::SwitchController(int n, double threshold, int sampleRate, double twindow)
-	: thetaCrossingOn(false), isLightOn(false),
-	tsLightOff(-1), tsIgnore(-1), tsHoldDur(-1), tsDelayLight(-1), tsClear(-1), holdTheta(0),
-	sampleRate(sampleRate), rfs(1000), twindow(twindow),
-	lightDur(0.2), ignoreDur(1), holdDur(0.2), clearDur(2.0), random_delay(0.5, 1.0), random_seed(72),
-	isDelayEnabled(false)
+	: sampleRate(sampleRate), rfs(1000), lightDur(0.2), ignoreDur(1), holdDur(0.2), clearDur(2.0),
+	random_delay(0.5, 1.0), random_seed(72), isDelayEnabled(false), thetaCrossingOn(false), isLightOn(false),
+	tsLightOff(-1), tsIgnore(-1), tsHoldDur(-1), tsDelayLight(-1), tsClear(-1), holdTheta(0), twindow(twindow),
+	onsetDetector(OnsetDetector::COUNTER), falseAlarmRate(1.0), twoStage(false), alertPending(false),
+	tsAlert(-1), alertsRaised(0), alertsConfirmed(0), alertsCancelled(0), confirmDelaySum(0), gateOpen(true),
+	threshold(threshold), timers(std::make_shared<TimerWheel>()), ownsTimers(true), timerBase(0),
+	lightDue(false), delayDue(false)
 {
 	random_engine.seed(random_seed);
 	setN(n);
@@ -20,6 +32,8 @@ void SwitchController::lightOn(long long tsBuffer, double holdTheta)
 	tsIgnore = tsBuffer + static_cast<int>(ignoreDur * rfs);
 	tsHoldDur = tsBuffer + static_cast<int>(holdDur * rfs);
 	this->holdTheta = holdTheta;
+	timers->schedule(timerBase + Timer::LIGHT_OFF, tsLightOff);
+	lightDue = false;
 	// std::cout << "Light ON\n";
 }
 
@@ -27,6 +41,8 @@ void SwitchController::lightOff()
 {
 	isLightOn = false;
 	tsLightOff = -1;
+	timers->cancel(timerBase + Timer::LIGHT_OFF);
+	lightDue = false;
 	// std::cout << "Light OFF\n";
 }
 
@@ -35,11 +51,15 @@ void SwitchController::delayOn(long long tsBuffer)
 	std::uniform_real_distribution<double> dist(random_delay.first, random_delay.second);
 	double delay = dist(random_engine) * rfs;
 	tsDelayLight = tsBuffer + static_cast<int>(delay);
+	timers->schedule(timerBase + Timer::DELAYED_LIGHT, tsDelayLight);
+	delayDue = false;
 }
 
 void SwitchController::delayOff()
 {
 	tsDelayLight = -1;
+	timers->cancel(timerBase + Timer::DELAYED_LIGHT);
+	delayDue = false;
 }
 
 void SwitchController::setDurAfterClear(long long tsBuffer)
@@ -52,23 +72,54 @@ bool SwitchController::checkIgnoreThetaAfterLight(long long tsBuffer)
 	return (tsBuffer >= tsIgnore) && (tsBuffer >= tsClear);
 }
 
-bool SwitchController::checkDelayFinish(long long tsBuffer)
+bool SwitchController::checkDelayFinish()
 {
-	return (tsBuffer >= tsDelayLight) && (tsDelayLight > 0);
+	return delayDue;
 }
 
-bool SwitchController::checkLightFinish(long long tsBuffer)
+bool SwitchController::checkLightFinish()
 {
-	return tsBuffer >= tsLightOff;
+	return lightDue;
 }
 
-bool SwitchController::isCrossingOn()
+void SwitchController::raiseAlert(long long tsBuffer)
 {
-	bool label = false;
-	for (int i = 0; i < n; i++) {
-		label = label || checkOverList[i].isup;
+	if (alertPending) {
+		// a new crossing joins the alert that is still pending
+		return;
+	}
+	alertPending = true;
+	tsAlert = tsBuffer;
+	alertsRaised++;
+}
+
+void SwitchController::resolveAlert(bool confirmed, long long tsBuffer)
+{
+	if (!alertPending) {
+		return;
+	}
+	alertPending = false;
+	if (confirmed) {
+		alertsConfirmed++;
+		confirmDelaySum += (tsBuffer - tsAlert) / rfs;
 	}
-	return label;
+	else {
+		alertsCancelled++;
+		delayOff();
+		if (isLightOn) {
+			lightOff();
+		}
+	}
+}
+
+bool SwitchController::isAlertPending()
+{
+	return alertPending;
+}
+
+bool SwitchController::isCrossingOn()
+{
+	return crossings.anyUp();
 }
 
 double SwitchController::checkHold(long long tsBuffer, double theta)
@@ -81,33 +132,46 @@ double SwitchController::checkHold(long long tsBuffer, double theta)
 	}
 }
 
-std::tuple<bool, bool, bool> SwitchController::checkTH(std::vector<double> out, long long tsBuffer, double theta)
+std::tuple<bool, bool, bool> SwitchController::checkTH(const std::vector<double>& out, long long tsBuffer, double theta)
 {
 	if (n < out.size()) {
 		setN(out.size());
 	}
+	if (ownsTimers) {
+		expiredTimers.clear();
+		timers->advance(tsBuffer, expiredTimers);
+		for (int id : expiredTimers) {
+			onTimer(id - timerBase);
+		}
+	}
 	addSample(out, theta);
 	bool crossing_on = isCrossingOn();
 
 	if (isDelayEnabled) {
-		if (crossing_on && checkIgnoreThetaAfterLight(tsBuffer) && !thetaCrossingOn) {
+		if (crossing_on && gateOpen && checkIgnoreThetaAfterLight(tsBuffer) && !thetaCrossingOn) {
 			thetaCrossingOn = true;
 			delayOff();
+			if (twoStage) {
+				raiseAlert(tsBuffer);
+			}
 		}
 		else if (thetaCrossingOn && !crossing_on && checkIgnoreThetaAfterLight(tsBuffer)) {
 			thetaCrossingOn = false;
 			delayOn(tsBuffer);
 		}
-		else if (!crossing_on && checkDelayFinish(tsBuffer)) {
+		else if (!crossing_on && checkDelayFinish()) {
 			lightOn(tsBuffer, theta);
 			delayOff();
 		}
 	}
 	else {
-		if (crossing_on && checkIgnoreThetaAfterLight(tsBuffer) && !thetaCrossingOn) {
+		if (crossing_on && gateOpen && checkIgnoreThetaAfterLight(tsBuffer) && !thetaCrossingOn) {
 			thetaCrossingOn = true;
 			// std::cout << "Theta Crossing On\n";
 			lightOn(tsBuffer, theta);
+			if (twoStage) {
+				raiseAlert(tsBuffer);
+			}
 		}
 		else if (thetaCrossingOn && !crossing_on) {
 			thetaCrossingOn = false;
@@ -115,18 +179,16 @@ std::tuple<bool, bool, bool> SwitchController::checkTH(std::vector<double> out,
 		}
 	}
 
-	if (isLightOn && checkLightFinish(tsBuffer)) {
+	if (isLightOn && checkLightFinish()) {
 		lightOff();
 	}
 
 	return std::tuple<bool, bool, bool>(isLightOn, thetaCrossingOn, crossing_on);
 }
 
-void SwitchController::addSample(std::vector<double> samples, double theta)
+void SwitchController::addSample(const std::vector<double>& samples, double theta)
 {
-	for (int i = 0; i < samples.size(); i++) {
-		checkOverList[i].addSample(samples[i], theta);
-	}
+	crossings.addSamples(samples.data(), std::min((int)samples.size(), n));
 }
 
 void SwitchController::clear(long long tsBuffer)
@@ -138,62 +200,281 @@ void SwitchController::clear(long long tsBuffer)
 	tsHoldDur = -1;
 	tsDelayLight = -1;
 	holdTheta = 0;
+	timers->cancel(timerBase + Timer::LIGHT_OFF);
+	timers->cancel(timerBase + Timer::DELAYED_LIGHT);
+	if (ownsTimers) {
+		timers->reset(tsBuffer);
+	}
+	lightDue = false;
+	delayDue = false;
+	alertPending = false;
+	tsAlert = -1;
 	setDurAfterClear(tsBuffer);
+	crossings.clear();
+}
+
+void SwitchController::setTH(const std::vector<double>& thresholds)
+{
+	crossings.setThresholds(thresholds.data(), std::min((int)thresholds.size(), n));
+}
 
-	for (int i = 0; i < n; i++) {
-		checkOverList[i].clear();
+void SwitchController::setTH(double threshold)
+{
+	this->threshold = threshold;
+	crossings.setThreshold(threshold);
+}
+
+void SwitchController::setN(int n)
+{
+	this->n = n;
+	setupCrossings(crossings, n, rfs, twindow, onsetDetector, falseAlarmRate, threshold);
+}
+
+void SwitchController::setupCrossings(CrossingBank& bank, int n, double rfs, double twindow,
+	OnsetDetector onset, double falseAlarmRate, double threshold)
+{
+	// Lorden: a CUSUM of log likelihood ratios that alarms at h has e^h hops or more
+	// between false alarms; the rate is shared by all bands
+	double hopsPerAlarm = 60.0 * rfs * std::max(n, 1) / std::max(falseAlarmRate, 1e-6);
+	double alarmLevel = std::log(std::max(hopsPerAlarm, 1.0));
+	bank.resize(n, static_cast<int>(rfs * twindow), onset, alarmLevel, threshold);
+}
+
+void SwitchController::swapCrossings(CrossingBank& bank)
+{
+	std::swap(crossings, bank);
+	n = crossings.size();
+}
+
+void SwitchController::setTimerWheel(std::shared_ptr<TimerWheel> wheel, int channel)
+{
+	timers->cancel(timerBase + Timer::LIGHT_OFF);
+	timers->cancel(timerBase + Timer::DELAYED_LIGHT);
+	timers = wheel;
+	ownsTimers = false;
+	timerBase = channel * Timer::TIMERS;
+	// deadlines that were pending move to the new wheel
+	if (isLightOn) {
+		timers->schedule(timerBase + Timer::LIGHT_OFF, tsLightOff);
+	}
+	if (tsDelayLight > 0) {
+		timers->schedule(timerBase + Timer::DELAYED_LIGHT, tsDelayLight);
 	}
 }
 
-void SwitchController::setTH(std::vector<double> thresholds)
+void SwitchController::onTimer(int timer)
 {
-	for (int i = 0; i < thresholds.size(); i++) {
-		checkOverList[i].threshold = thresholds[i];
+	if (timer == Timer::LIGHT_OFF) {
+		lightDue = true;
+	}
+	else if (timer == Timer::DELAYED_LIGHT) {
+		delayDue = true;
 	}
 }
 
-void SwitchController::setTH(double threshold)
+void SwitchController::setGate(bool open)
+{
+	gateOpen = open;
+}
+
+std::tuple<bool, bool, bool> SwitchController::freeze(long long tsBuffer)
 {
-	for (int i = 0; i < n; i++) {
-		checkOverList[i].threshold = threshold;
+	if (ownsTimers) {
+		expiredTimers.clear();
+		timers->advance(tsBuffer, expiredTimers);
+		for (int id : expiredTimers) {
+			onTimer(id - timerBase);
+		}
+	}
+	if (checkDelayFinish()) {
+		delayOff();
+	}
+	if (isLightOn && checkLightFinish()) {
+		lightOff();
 	}
+	return std::tuple<bool, bool, bool>(isLightOn, thetaCrossingOn, false);
 }
 
-void SwitchController::setN(int n)
+
+/* CrossingBank */
+IIR_SIMD_CLONES
+static void countCrossings(const double* samples, const double* thresholds, int* counts,
+	uint8_t* flags, int count, int twindow)
 {
-	this->n = n;
-	checkOverList.resize(n);
-	for (int i = 0; i < n; i++) {
-		checkOverList[i] = checkOver(static_cast<int>(rfs * twindow));
+	for (int i = 0; i < count; i++) {
+		// saturates one past the window, where the entry is up
+		const int over = (samples[i] >= thresholds[i]);
+		counts[i] = (std::min(counts[i], twindow) + 1) * over;
+	}
+	// a separate pass: narrowing to bytes in the loop above halves its width.
+	// Without a movemask the vectorizer can only build the words from the
+	// compares with a shift and an OR per lane, which costs more than this
+	// pass and packFlags together
+	for (int i = 0; i < count; i++) {
+		flags[i] = (counts[i] > twindow);
 	}
 }
 
+// eight 0/1 bytes to eight bits, byte 0 to bit 0 (little endian)
+static inline uint64_t packFlags(const uint8_t* flags)
+{
+	uint64_t bytes;
+	std::memcpy(&bytes, flags, 8);
+	return (bytes * 0x0102040810204080ULL) >> 56;
+}
 
-/* CheckOver */ 
-checkOver::checkOver(int twindow): twindow(twindow)
+CrossingBank::CrossingBank() : n(0), twindow(0), onset(OnsetDetector::COUNTER), alarmLevel(0)
 {
+}
+
+void CrossingBank::resize(int n, int twindow, OnsetDetector onset, double alarmLevel, double threshold)
+{
+	this->n = n;
+	this->twindow = twindow;
+	this->onset = onset;
+	this->alarmLevel = alarmLevel;
+	thresholds.assign(n, threshold);
+	counts.resize(n);
+	// padded to whole words, the padding stays down
+	up.resize((n + 63) / 64);
+	flags.resize(up.size() * 64);
+	if (onset == OnsetDetector::CUSUM) {
+		for (std::vector<double>* v : { &cusum, &logMean, &logM2, &logUpper, &logLag, &lastDeviation }) {
+			v->resize(n);
+		}
+		logCount.resize(n);
+		upperCount.resize(n);
+	}
+	else {
+		for (std::vector<double>* v : { &cusum, &logMean, &logM2, &logUpper, &logLag, &lastDeviation }) {
+			v->clear();
+		}
+		logCount.clear();
+		upperCount.clear();
+	}
 	clear();
 }
 
-void checkOver::addSample(double sample, double theta)
+void CrossingBank::setThresholds(const double* thresholds, int count)
+{
+	std::copy(thresholds, thresholds + std::min(count, n), this->thresholds.begin());
+}
+
+void CrossingBank::setThreshold(double threshold)
+{
+	std::fill(thresholds.begin(), thresholds.end(), threshold);
+}
+
+void CrossingBank::addSamples(const double* samples, int count)
 {
-	is_over = (sample >= threshold);
-	if (is_over) {
-		count++;
+	count = std::min(count, n);
+	if (onset == OnsetDetector::CUSUM) {
+		addEvidence(samples, count);
 	}
 	else {
-		count = 0;
+		countCrossings(samples, thresholds.data(), counts.data(), flags.data(), count, twindow);
+	}
+	for (int w = 0; w < (count + 63) / 64; w++) {
+		uint64_t word = 0;
+		for (int byte = 0; byte < 8; byte++) {
+			word |= packFlags(&flags[w * 64 + byte * 8]) << (byte * 8);
+		}
+		up[w] = word;
+	}
+}
+
+void CrossingBank::addEvidence(const double* samples, int count)
+{
+	for (int i = 0; i < count; i++) {
+		const bool isup = flags[i];
+		const bool is_over = (samples[i] >= thresholds[i]);
+		double x = std::log(std::max(samples[i], CUSUM_FLOOR));
+		if (!isup) {
+			// baseline statistics leave out the bursts
+			logCount[i]++;
+			double delta = x - logMean[i];
+			logMean[i] += delta / logCount[i];
+			double deviation = x - logMean[i];
+			if (deviation > 0) {
+				logUpper[i] += deviation * deviation;
+				upperCount[i]++;
+			}
+			logM2[i] += delta * deviation;
+			logLag[i] += lastDeviation[i] * deviation;
+			lastDeviation[i] = deviation;
+		}
+		else {
+			lastDeviation[i] = 0;
+		}
+		if (logCount[i] < CUSUM_MIN_BASELINE || upperCount[i] < 2) {
+			continue;
+		}
+
+		// two gaussians at the baseline mean and at the threshold. Log band power is
+		// skewed to the left; only rises matter here, so the spread is the upper one.
+		double variance = std::max(logUpper[i] / upperCount[i], CUSUM_FLOOR);
+		double shift = std::max(std::log(std::max(thresholds[i], CUSUM_FLOOR)) - logMean[i],
+			CUSUM_MIN_SEPARATION * std::sqrt(variance));
+		// band power is correlated over the window; as for an AR(1) process,
+		// (1 - r) / (1 + r) of every hop is independent evidence
+		double r = (logM2[i] > 0) ? std::min(std::max(logLag[i] / logM2[i], 0.0), CUSUM_MAX_CORRELATION) : 0.0;
+		double weight = (1 - r) / (1 + r);
+		cusum[i] = std::max(0.0, cusum[i] + weight * shift / variance * (x - logMean[i] - shift / 2));
+
+		if (isup) {
+			// offset as with the counter: the first hop below the threshold
+			flags[i] = is_over;
+			if (!is_over) {
+				cusum[i] = 0;
+			}
+		}
+		else {
+			flags[i] = (cusum[i] >= alarmLevel);
+		}
 	}
+}
 
-	isprevup = isup;
-	isup = (count > twindow);
+void CrossingBank::clear()
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	std::fill(flags.begin(), flags.end(), 0);
+	std::fill(up.begin(), up.end(), 0);
+	for (std::vector<double>* v : { &cusum, &logMean, &logM2, &logUpper, &logLag, &lastDeviation }) {
+		std::fill(v->begin(), v->end(), 0.0);
+	}
+	std::fill(logCount.begin(), logCount.end(), 0);
+	std::fill(upperCount.begin(), upperCount.end(), 0);
 }
 
-void checkOver::clear()
+bool CrossingBank::anyUp() const
 {
-	count = 0;
-	isprevup = false;
-	isup = false;
-	is_over = false;
+	uint64_t any = 0;
+	for (uint64_t word : up) {
+		any |= word;
+	}
+	return any != 0;
 }
 
+int CrossingBank::countUp() const
+{
+	int count = 0;
+	for (uint64_t word : up) {
+		count += (int)std::bitset<64>(word).count();
+	}
+	return count;
+}
+
+bool CrossingBank::isUp(int i) const
+{
+	return flags[i] != 0;
+}
+
+int CrossingBank::size() const
+{
+	return n;
+}
+
+const uint64_t* CrossingBank::getWords() const
+{
+	return up.data();
+}
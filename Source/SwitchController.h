@@ -1,26 +1,71 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <random>
+#include <tuple>
+#include <vector>
 
-class checkOver
+#include "TimerWheel.h"
+
+enum OnsetDetector { COUNTER = 0, CUSUM };
+
+/*
+ * Threshold crossing state of many entries (bands x channels) at once. Every
+ * per-entry value lives in its own array, so the counter onset is one
+ * vectorized pass over the hop's band powers. The up states are packed into
+ * 64-bit words after every hop; "any band up" and the count of bands up are
+ * tests and popcounts of those words.
+ */
+class CrossingBank
 {
 public:
-    checkOver(int twindow=0);
+    CrossingBank();
 
-    void addSample(double sample, double theta);
+    // resets every entry; thresholds are set to threshold
+    void resize(int n, int twindow, OnsetDetector onset, double alarmLevel, double threshold);
+    void setThresholds(const double* thresholds, int count);
+    void setThreshold(double threshold);
+    void addSamples(const double* samples, int count);
     void clear();
 
-    int count;
-    bool isprevup;
-    bool isup;
-    bool is_over;
+    bool anyUp() const;
+    int countUp() const;
+    bool isUp(int i) const;
+    int size() const;
+    const uint64_t* getWords() const;   // the up bits, (size() + 63) / 64 words
+
+private:
+    // CUSUM onset: log likelihood ratio of "at the threshold" against the
+    // baseline of log band power, accumulated until it reaches alarmLevel
+    void addEvidence(const double* samples, int count);
+
+    int n;
     int twindow;
+    OnsetDetector onset;
+    double alarmLevel;
 
-    double threshold;
+    std::vector<double> thresholds;
+    std::vector<int> counts;
+    std::vector<uint8_t> flags; // up state per entry
+    std::vector<uint64_t> up;   // the same, one bit per entry
+
+    std::vector<double> cusum, logMean, logM2, logUpper, logLag, lastDeviation;
+    std::vector<long long> logCount, upperCount;
 };
 
+/*
+ * Light and delayed-light deadlines run on a TimerWheel in hops, so a hop
+ * with nothing due only advances the wheel. By default every controller
+ * owns a wheel and advances it in checkTH. Controllers given one shared
+ * wheel (setTimerWheel) use the timer ids channel * TIMERS + Timer; whoever
+ * owns it advances it once per hop and passes every expired id on to
+ * onTimer(id % TIMERS) of controller id / TIMERS.
+ */
 class SwitchController {
 public:
+    enum Timer { LIGHT_OFF = 0, DELAYED_LIGHT, TIMERS };
+
 	SwitchController(int n=10, double threshold = 0.5, int sampleRate = 1000, double twindow = 0.2);
     void lightOn(long long tsBuffer, double holdTheta);
     void lightOff();
@@ -28,20 +73,35 @@ public:
     void delayOff();
     void setDurAfterClear(long long tsBuffer);
     bool checkIgnoreThetaAfterLight(long long tsBuffer);
-    bool checkDelayFinish(long long tsBuffer);
-    bool checkLightFinish(long long tsBuffer);
+    bool checkDelayFinish();
+    bool checkLightFinish();
     bool isCrossingOn();
+    void raiseAlert(long long tsBuffer);
+    void resolveAlert(bool confirmed, long long tsBuffer);
+    bool isAlertPending();
     double checkHold(long long tsBuffer, double theta);
 
-    std::tuple<bool, bool, bool> checkTH(std::vector<double> out, long long tsBuffer, double theta);
-    void addSample(std::vector<double> samples, double theta);
+    std::tuple<bool, bool, bool> checkTH(const std::vector<double>& out, long long tsBuffer, double theta);
+    void addSample(const std::vector<double>& samples, double theta);
     void clear(long long tsBuffer);
-    void setTH(std::vector<double> thresholds);
+    void setTH(const std::vector<double>& thresholds);
     void setTH(double threshold);
     void setN(int n);
+    // the crossings setN would build, made ready off the detection thread and
+    // put in place by swapCrossings
+    static void setupCrossings(CrossingBank& bank, int n, double rfs, double twindow,
+        OnsetDetector onset, double falseAlarmRate, double threshold);
+    void swapCrossings(CrossingBank& bank);
+    void setTimerWheel(std::shared_ptr<TimerWheel> wheel, int channel);
+    void onTimer(int timer);
+    // a closed gate holds back new crossings; one already on runs its course
+    void setGate(bool open);
+    // a hop without detection: the timers run, a due light still goes off and
+    // a due delayed light is dropped; the crossings are left as they were
+    std::tuple<bool, bool, bool> freeze(long long tsBuffer);
 
     int sampleRate;
-    int rfs;
+    double rfs;     // rate at which checkTH is called
     double lightDur;
     double ignoreDur;
     double holdDur;
@@ -59,9 +119,28 @@ public:
     int tsClear;
     double holdTheta;
     double twindow;
+    OnsetDetector onsetDetector;
+    double falseAlarmRate;  // per minute over all bands, for the CUSUM onset
+
+    // two-stage detection: the light follows the provisional onset, and the
+    // alert stays pending until it is confirmed or cancelled (resolveAlert);
+    // a cancellation switches the light off and drops a delayed one
+    bool twoStage;
+    bool alertPending;
+    long long tsAlert;
+    int alertsRaised, alertsConfirmed, alertsCancelled;
+    double confirmDelaySum;     // s
+    bool gateOpen;
 
     int n;
-    std::vector<checkOver> checkOverList;
+    double threshold;   // for entries added by setN
+    CrossingBank crossings;
+
+    std::shared_ptr<TimerWheel> timers;
+    bool ownsTimers;
+    int timerBase;
+    bool lightDue, delayDue;
+    std::vector<int> expiredTimers;
 
     std::default_random_engine random_engine;
 };
@@ -0,0 +1,119 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+
+/* TimerWheel */
+TimerWheel::TimerWheel() : now(0), numPending(0)
+{
+}
+
+void TimerWheel::reset(long long now)
+{
+	for (int level = 0; level < LEVELS; level++) {
+		for (int slot = 0; slot < SLOTS; slot++) {
+			slots[level][slot].clear();
+		}
+	}
+	overflow.clear();
+	for (unsigned& generation : generations) {
+		generation++;
+	}
+	std::fill(pending.begin(), pending.end(), false);
+	this->now = now;
+	numPending = 0;
+}
+
+void TimerWheel::schedule(int id, long long deadline)
+{
+	if (id >= (int)generations.size()) {
+		generations.resize(id + 1, 0);
+		pending.resize(id + 1, false);
+	}
+	cancel(id);
+	pending[id] = true;
+	numPending++;
+	insert({ id, generations[id], deadline }, now + 1);
+}
+
+void TimerWheel::cancel(int id)
+{
+	if (isPending(id)) {
+		generations[id]++;
+		pending[id] = false;
+		numPending--;
+	}
+}
+
+bool TimerWheel::isPending(int id) const
+{
+	return id < (int)pending.size() && pending[id];
+}
+
+void TimerWheel::insert(const Entry& entry, long long tick)
+{
+	const long long due = std::max(entry.deadline, tick);
+	const long long delta = due - tick;
+	for (int level = 0; level < LEVELS; level++) {
+		if (delta < (1LL << (SLOT_BITS * (level + 1)))) {
+			slots[level][(due >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(entry);
+			return;
+		}
+	}
+	overflow.push_back(entry);
+}
+
+bool TimerWheel::isCurrent(const Entry& entry) const
+{
+	return pending[entry.id] && generations[entry.id] == entry.generation;
+}
+
+void TimerWheel::advance(long long now, std::vector<int>& expired)
+{
+	if (numPending == 0) {
+		this->now = std::max(now, this->now);
+		return;
+	}
+	for (long long tick = this->now + 1; tick <= now; tick++) {
+		// every SLOTS^L ticks the next level L slot moves down, the highest level first
+		int top = 0;
+		while (top < LEVELS && (tick & ((1LL << (SLOT_BITS * (top + 1))) - 1)) == 0) {
+			top++;
+		}
+		for (int level = top; level >= 1; level--) {
+			std::vector<Entry>& source = (level == LEVELS) ? overflow :
+				slots[level][(tick >> (SLOT_BITS * level)) & (SLOTS - 1)];
+			cascade.clear();
+			cascade.swap(source);
+			for (const Entry& entry : cascade) {
+				if (isCurrent(entry)) {
+					insert(entry, tick);
+				}
+			}
+		}
+
+		std::vector<Entry>& due = slots[0][tick & (SLOTS - 1)];
+		for (const Entry& entry : due) {
+			if (isCurrent(entry)) {
+				pending[entry.id] = false;
+				numPending--;
+				expired.push_back(entry.id);
+			}
+		}
+		due.clear();
+		this->now = tick;
+		if (numPending == 0) {
+			this->now = now;
+			break;
+		}
+	}
+}
+
+long long TimerWheel::getNow() const
+{
+	return now;
+}
+
+int TimerWheel::getNumPending() const
+{
+	return numPending;
+}
@@ -0,0 +1,59 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <vector>
+
+
+/*
+ * Hierarchical timer wheel: LEVELS wheels of SLOTS slots, level L slot s
+ * holding the timers due in the s-th span of SLOTS^L ticks. A timer sits
+ * in the lowest level that reaches its deadline and moves down one level
+ * at a time as the clock gets there, so advancing the clock touches only
+ * the slots that come due, whatever the number of timers. Timers are small
+ * integer ids; rescheduling or cancelling one leaves its old entry behind,
+ * to be skipped when its slot comes up.
+ */
+class TimerWheel
+{
+public:
+	TimerWheel();
+
+	// drops every timer and restarts the clock at now
+	void reset(long long now);
+	// arms timer id for deadline, replacing its pending deadline; deadlines
+	// that are not after the clock fire on the next advance
+	void schedule(int id, long long deadline);
+	void cancel(int id);
+	bool isPending(int id) const;
+
+	// moves the clock to now and appends the timers due by then to expired,
+	// earliest first
+	void advance(long long now, std::vector<int>& expired);
+	long long getNow() const;
+	int getNumPending() const;
+
+private:
+	static const int SLOT_BITS = 6;
+	static const int SLOTS = 1 << SLOT_BITS;
+	static const int LEVELS = 4;
+
+	struct Entry {
+		int id;
+		unsigned generation;
+		long long deadline;
+	};
+
+	// into the slot for entry.deadline as seen from tick, the next one to run
+	void insert(const Entry& entry, long long tick);
+	bool isCurrent(const Entry& entry) const;
+
+	std::vector<Entry> slots[LEVELS][SLOTS];
+	std::vector<Entry> overflow;	// beyond SLOTS^LEVELS ticks
+	std::vector<Entry> cascade;
+	std::vector<unsigned> generations;
+	std::vector<bool> pending;
+	long long now;
+	int numPending;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "utils.h"
+#include <map>
+#include <mutex>
+
+
+/* TwiddleCache */
+std::shared_ptr<const TwiddleCache::Table> TwiddleCache::get(int nfft)
+{
+	static std::mutex mutex;
+	static std::map<int, std::weak_ptr<const Table>> tables;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::shared_ptr<const Table> table = tables[nfft].lock();
+	if (table) {
+		return table;
+	}
+
+	auto created = std::make_shared<Table>(nfft);
+	for (int i = 0; i < nfft; i++) {
+		(*created)[i] = std::complex<double>(std::cos(2 * M_PI * i / nfft), std::sin(2 * M_PI * i / nfft));
+	}
+	tables[nfft] = created;
+
+	// drop the entries nobody uses any more
+	for (auto it = tables.begin(); it != tables.end();) {
+		if (it->second.expired()) {
+			it = tables.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	return created;
+}
@@ -5,10 +5,6 @@ SmoothList::SmoothList(int num, double k): num(num), k(0.9)
 	setN(num);
 }
 
-SmoothList::~SmoothList()
-{
-}
-
 void SmoothList::setN(int num)
 {
 	this->num = num;
@@ -18,7 +14,7 @@ void SmoothList::setN(int num)
 	}
 }
 
-void SmoothList::addSamples(std::vector<double> data)
+void SmoothList::addSamples(const std::vector<double>& data)
 {
 	for (int i = 0; i < num; i++) {
 		list[i].addSample(data[i]);
@@ -28,10 +24,16 @@ void SmoothList::addSamples(std::vector<double> data)
 std::vector<double> SmoothList::getRes()
 {
 	std::vector<double> tmp(num);
+	getRes(tmp);
+	return tmp;
+}
+
+void SmoothList::getRes(std::vector<double>& res)
+{
+	res.resize(num);
 	for (int i = 0; i < num; i++) {
-		tmp[i] = list[i].getRes();
+		res[i] = list[i].getRes();
 	}
-	return tmp;
 }
 
 void SmoothList::clear()
@@ -55,10 +57,6 @@ STDList::STDList(int num) : num(num)
 	setN(num);
 }
 
-STDList::~STDList()
-{
-}
-
 void STDList::setN(int num)
 {
 	this->num = num;
@@ -68,7 +66,7 @@ void STDList::setN(int num)
 	}
 }
 
-void STDList::addSamples(std::vector<double> data)
+void STDList::addSamples(const std::vector<double>& data)
 {
 	for (int i = 0; i < num; i++) {
 		list[i].addSample(data[i]);
@@ -84,8 +82,14 @@ void STDList::clear()
 std::vector<double> STDList::getResN(float n)
 {
 	std::vector<double> tmp(num);
+	getResN(n, tmp);
+	return tmp;
+}
+
+void STDList::getResN(float n, std::vector<double>& res)
+{
+	res.resize(num);
 	for (int i = 0; i < num; i++) {
-		tmp[i] = list[i].getResN(n);
+		res[i] = list[i].getResN(n);
 	}
-	return tmp;
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+/**
+ *
+ * "A Collection of Useful C++ Classes for Digital Signal Processing"
+ * By Vinnie Falco and Bernd Porr
+ *
+ * Official project location:
+ * https://github.com/berndporr/iir1
+ *
+ * See Documentation.cpp for contact information, notes, and bibliography.
+ * 
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ * Copyright (c) 2009 by Vinnie Falco
+ * Copyright (c) 2011 by Bernd Porr
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+
+#include "Common.h"
+#include "Bessel.h"
+
+namespace Iir {
+
+namespace Bessel {
+
+// Coefficients of the reverse Bessel polynomial, lowest power first
+static std::vector<double> reverseBessel (int n)
+{
+  std::vector<double> a (n + 1);
+  // a_k = (2n-k)! / (2^(n-k) k! (n-k)!), built up from a_n = 1
+  a[n] = 1;
+  for (int k = n; k > 0; --k)
+    a[k - 1] = a[k] * (2 * n - k + 1) * k / (2.0 * (n - k + 1));
+  return a;
+}
+
+static complex_t evaluate (const std::vector<double>& a, const complex_t& s)
+{
+  complex_t p (0);
+  for (int k = (int)a.size () - 1; k >= 0; --k)
+    p = p * s + a[k];
+  return p;
+}
+
+// Durand-Kerner iteration on the monic polynomial a
+static std::vector<complex_t> roots (const std::vector<double>& a)
+{
+  const int n = (int)a.size () - 1;
+  std::vector<complex_t> z (n);
+  for (int i = 0; i < n; ++i)
+    z[i] = std::pow (complex_t (0.4, 0.9), i) * std::pow (a[0], 1.0 / n);
+
+  for (int iter = 0; iter < 500; ++iter)
+  {
+    double change = 0;
+    for (int i = 0; i < n; ++i)
+    {
+      complex_t d (1);
+      for (int j = 0; j < n; ++j)
+        if (j != i) d *= z[i] - z[j];
+      const complex_t step = evaluate (a, z[i]) / d;
+      z[i] -= step;
+      change = std::max (change, std::abs (step) / (1 + std::abs (z[i])));
+    }
+    if (change < 1e-14)
+      break;
+  }
+  return z;
+}
+
+AnalogLowPass::AnalogLowPass ()
+  : m_numPoles (-1)
+{
+  setNormal (0, 1);
+}
+
+void AnalogLowPass::design (int numPoles)
+{
+  if (m_numPoles != numPoles)
+  {
+    m_numPoles = numPoles;
+
+    reset ();
+
+    const std::vector<double> a = reverseBessel (numPoles);
+    std::vector<complex_t> poles = roots (a);
+
+    // the polynomial has unit delay at DC; rescale to -3dB at w = 1
+    double lo = 0.1, hi = 10;
+    for (int i = 0; i < 100; ++i)
+    {
+      const double w = 0.5 * (lo + hi);
+      const double mag = a[0] / std::abs (evaluate (a, complex_t (0, w)));
+      if (mag > std::sqrt (0.5)) lo = w; else hi = w;
+    }
+    const double w3 = 0.5 * (lo + hi);
+
+    for (auto& p : poles)
+    {
+      p /= w3;
+      if (p.imag () > 1e-9)
+        addPoleZeroConjugatePairs (p, infinity());
+      else if (std::abs (p.imag ()) <= 1e-9)
+        add (p.real (), infinity());
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void LowPassBase::setup (int order,
+                         double cutoffFrequency)
+{
+  m_analogProto.design (order);
+
+  LowPassTransform (cutoffFrequency,
+                    m_digitalProto,
+                    m_analogProto);
+
+  Cascade::setLayout (m_digitalProto);
+}
+
+void HighPassBase::setup (int order,
+                          double cutoffFrequency)
+{
+  m_analogProto.design (order);
+
+  HighPassTransform (cutoffFrequency,
+                     m_digitalProto,
+                     m_analogProto);
+
+  Cascade::setLayout (m_digitalProto);
+}
+
+void BandPassBase::setup (int order,
+                          double centerFrequency,
+                          double widthFrequency)
+{
+  m_analogProto.design (order);
+
+  BandPassTransform (centerFrequency,
+                     widthFrequency,
+                     m_digitalProto,
+                     m_analogProto);
+
+  Cascade::setLayout (m_digitalProto);
+}
+
+}
+
+}
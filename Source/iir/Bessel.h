@@ -0,0 +1,194 @@
+/**
+ *
+ * "A Collection of Useful C++ Classes for Digital Signal Processing"
+ * By Vinnie Falco and Bernd Porr
+ *
+ * Official project location:
+ * https://github.com/berndporr/iir1
+ *
+ * See Documentation.txt for contact information, notes, and bibliography.
+ * 
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ * Copyright (c) 2009 by Vinnie Falco
+ * Copyright (c) 2011-2021 by Bernd Porr
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+
+#ifndef IIR1_BESSEL_H
+#define IIR1_BESSEL_H
+
+#include "Common.h"
+#include "Cascade.h"
+#include "PoleFilter.h"
+#include "State.h"
+
+namespace Iir {
+
+/**
+ * Filters with Bessel response characteristics. The analog prototype has a
+ * maximally flat group delay, so the delay varies little across the passband
+ * and is lower than that of a Butterworth of the same order near the band edges.
+ * The prototype is normalised to -3dB at the cutoff like the Butterworth one.
+ **/
+namespace Bessel {
+
+/**
+ * Analogue lowpass prototype with the poles at the roots of the
+ * reverse Bessel polynomial, found numerically.
+ **/
+class IIR_EXPORT AnalogLowPass : public LayoutBase
+{
+public:
+	AnalogLowPass ();
+
+	void design (const int numPoles);
+
+private:
+	int m_numPoles = 0;
+};
+
+//------------------------------------------------------------------------------
+
+struct IIR_EXPORT LowPassBase : PoleFilterBase <AnalogLowPass>
+{
+	void setup (int order,
+		    double cutoffFrequency);
+};
+
+struct IIR_EXPORT HighPassBase : PoleFilterBase <AnalogLowPass>
+{
+	void setup (int order,
+		    double cutoffFrequency);
+};
+
+struct IIR_EXPORT BandPassBase : PoleFilterBase <AnalogLowPass>
+{
+	void setup (int order,
+		    double centerFrequency,
+		    double widthFrequency);
+};
+
+//------------------------------------------------------------------------------
+
+//
+// Filters for the user
+//
+
+/**
+ * Bessel Lowpass filter.
+ * \param FilterOrder  Reserves memory for a filter of the order FilterOrder
+ * \param StateType    The filter topology: DirectFormI, DirectFormII, ...
+ */
+template <int FilterOrder = DEFAULT_FILTER_ORDER, class StateType = DEFAULT_STATE>
+struct LowPass : PoleFilter <LowPassBase, StateType, FilterOrder>
+{
+	/**
+	 * Calculates the coefficients with the filter order provided by the instantiation
+	 * \param sampleRate Sampling rate
+	 * \param cutoffFrequency Cutoff frequency
+	 **/
+	void setup (double sampleRate,
+		    double cutoffFrequency) {
+		LowPassBase::setup (FilterOrder,
+				    cutoffFrequency / sampleRate);
+	}
+
+	/**
+	 * Calculates the coefficients with the filter order provided by the instantiation
+	 * \param cutoffFrequency Normalised cutoff frequency (0..1/2)
+	 **/
+	void setupN(double cutoffFrequency) {
+		LowPassBase::setup (FilterOrder,
+				    cutoffFrequency);
+	}
+};
+
+/**
+ * Bessel Highpass filter.
+ * \param FilterOrder  Reserves memory for a filter of the order FilterOrder
+ * \param StateType    The filter topology: DirectFormI, DirectFormII, ...
+ */
+template <int FilterOrder = DEFAULT_FILTER_ORDER, class StateType = DEFAULT_STATE>
+struct HighPass : PoleFilter <HighPassBase, StateType, FilterOrder>
+{
+	/**
+	 * Calculates the coefficients with the filter order provided by the instantiation
+	 * \param sampleRate Sampling rate
+	 * \param cutoffFrequency Cutoff frequency
+	 **/
+	void setup (double sampleRate,
+		    double cutoffFrequency) {
+		HighPassBase::setup (FilterOrder,
+				     cutoffFrequency / sampleRate);
+	}
+
+	/**
+	 * Calculates the coefficients with the filter order provided by the instantiation
+	 * \param cutoffFrequency Normalised cutoff frequency (0..1/2)
+	 **/
+	void setupN(double cutoffFrequency) {
+		HighPassBase::setup (FilterOrder,
+				     cutoffFrequency);
+	}
+};
+
+/**
+ * Bessel Bandpass filter.
+ * \param FilterOrder  Reserves memory for a filter of the order FilterOrder
+ * \param StateType    The filter topology: DirectFormI, DirectFormII, ...
+ */
+template <int FilterOrder = DEFAULT_FILTER_ORDER, class StateType = DEFAULT_STATE>
+struct BandPass : PoleFilter <BandPassBase, StateType, FilterOrder, FilterOrder*2>
+{
+	/**
+	 * Calculates the coefficients with the filter order provided by the instantiation
+	 * \param sampleRate Sampling rate
+	 * \param centerFrequency Centre frequency of the bandpass
+	 * \param widthFrequency Width of the bandpass
+	 **/
+	void setup (double sampleRate,
+		    double centerFrequency,
+		    double widthFrequency) {
+		BandPassBase::setup(FilterOrder,
+				    centerFrequency / sampleRate,
+				    widthFrequency / sampleRate);
+	}
+
+	/**
+	 * Calculates the coefficients with the filter order provided by the instantiation
+	 * \param centerFrequency Normalised centre frequency (0..1/2) of the bandpass
+	 * \param widthFrequency Width of the bandpass in normalised freq
+	 **/
+	void setupN(double centerFrequency,
+		    double widthFrequency) {
+		BandPassBase::setup(FilterOrder,
+				    centerFrequency,
+				    widthFrequency);
+	}
+};
+
+}
+
+}
+
+#endif
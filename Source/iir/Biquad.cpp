@@ -112,6 +112,31 @@ namespace Iir {
 		return ch / cbot;
 	}
 
+	// For P(z) = sum_k p_k z^-k the delay is Re { sum_k k p_k z^-k / P(z) }
+	// and the delay of B/A is the delay of B minus the delay of A.
+	static double polynomialDelay (double p0, double p1, double p2,
+				       const complex_t& czn1, const complex_t& czn2)
+	{
+		complex_t p (p0);
+		p = addmul (p, p1, czn1);
+		p = addmul (p, p2, czn2);
+		complex_t dp (0);
+		dp = addmul (dp, p1, czn1);
+		dp = addmul (dp, 2 * p2, czn2);
+		if (std::abs (p) < 1e-12) return 0;
+		return (dp / p).real ();
+	}
+
+	double Biquad::groupDelay (double normalizedFrequency) const
+	{
+		const double w = 2 * doublePi * normalizedFrequency;
+		const complex_t czn1 = std::polar (1., -w);
+		const complex_t czn2 = std::polar (1., -2 * w);
+
+		return polynomialDelay (getB0 (), getB1 (), getB2 (), czn1, czn2) -
+			polynomialDelay (getA0 (), getA1 (), getA2 (), czn1, czn2);
+	}
+
 	std::vector<PoleZeroPair> Biquad::getPoleZeros () const
 	{
 		std::vector<PoleZeroPair> vpz;
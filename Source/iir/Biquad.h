@@ -60,6 +60,12 @@ namespace Iir {
 	 **/
 	complex_t response (double normalizedFrequency) const;
 
+	/**
+	 * Calculate the group delay in samples at the given normalized frequency
+	 * (-d phase / d omega, computed analytically from the coefficients).
+	 **/
+	double groupDelay (double normalizedFrequency) const;
+
 	/**
 	 * Returns the pole / zero Pairs as a vector.
 	 **/
@@ -75,6 +75,17 @@ namespace Iir {
 		return ch / cbot;
 	}
 
+	double Cascade::groupDelay (double normalizedFrequency) const
+	{
+		if (normalizedFrequency > 0.5) throw_invalid_argument(maxFError);
+		if (normalizedFrequency < 0.0) throw_invalid_argument(minFError);
+		double delay = 0;
+		const Biquad* stage = m_stageArray;
+		for (int i = m_numStages; --i >=0; ++stage)
+			delay += stage->groupDelay (normalizedFrequency);
+		return delay;
+	}
+
 	std::vector<PoleZeroPair> Cascade::getPoleZeros () const
 	{
 		std::vector<PoleZeroPair> vpz;
@@ -86,6 +86,12 @@ namespace Iir {
          **/
         complex_t response (double normalizedFrequency) const;
 
+        /**
+         * Calculate the group delay in samples at the given normalized frequency
+         * \param normalizedFrequency Frequency from 0 to 0.5 (Nyquist)
+         **/
+        double groupDelay (double normalizedFrequency) const;
+
         /**
          * Returns a vector with all pole/zero pairs of the whole Biqad cascade
          **/
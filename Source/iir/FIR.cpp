@@ -0,0 +1,200 @@
+/**
+ *
+ * "A Collection of Useful C++ Classes for Digital Signal Processing"
+ * By Vinnie Falco and Bernd Porr
+ *
+ * Official project location:
+ * https://github.com/berndporr/iir1
+ *
+ * See Documentation.cpp for contact information, notes, and bibliography.
+ * 
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ * Copyright (c) 2009 by Vinnie Falco
+ * Copyright (c) 2011 by Bernd Porr
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+
+#include "Common.h"
+#include "FIR.h"
+
+#include <algorithm>
+
+namespace Iir {
+
+namespace FIR {
+
+static double lowpassTap (double cutoff, double m)
+{
+  // ideal lowpass impulse response 2 fc sinc(2 fc m)
+  if (m == 0) return 2 * cutoff;
+  return sin (2 * doublePi * cutoff * m) / (doublePi * m);
+}
+
+// in-place radix 2 FFT, size a power of two; inverse without the 1/n
+static void fft (std::vector<complex_t>& a, bool inverse)
+{
+  const int n = (int)a.size ();
+  for (int i = 1, j = 0; i < n; i++)
+  {
+    int bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap (a[i], a[j]);
+  }
+  for (int len = 2; len <= n; len <<= 1)
+  {
+    const complex_t step = std::polar (1., (inverse ? 2 : -2) * doublePi / len);
+    for (int i = 0; i < n; i += len)
+    {
+      complex_t w (1);
+      for (int k = 0; k < len / 2; k++)
+      {
+        const complex_t u = a[i + k];
+        const complex_t v = a[i + k + len / 2] * w;
+        a[i + k] = u + v;
+        a[i + k + len / 2] = u - v;
+        w *= step;
+      }
+    }
+  }
+}
+
+void BandPass::setupN (double centerFrequency,
+                       double widthFrequency,
+                       int numTaps,
+                       bool minimumPhase)
+{
+  if (numTaps < 1) numTaps = 1;
+  m_numTaps = numTaps | 1;
+
+  const double f1 = std::max (centerFrequency - widthFrequency / 2, 0.0);
+  const double f2 = std::min (centerFrequency + widthFrequency / 2, 0.5);
+  const double mid = (m_numTaps - 1) / 2.0;
+
+  m_taps.resize (m_numTaps);
+  for (int i = 0; i < m_numTaps; i++)
+  {
+    const double m = i - mid;
+    const double window = (m_numTaps > 1) ? 0.54 - 0.46 * cos (2 * doublePi * i / (m_numTaps - 1)) : 1;
+    m_taps[i] = window * (lowpassTap (f2, m) - lowpassTap (f1, m));
+  }
+
+  m_minimumPhase = minimumPhase && m_numTaps > 1;
+  if (m_minimumPhase)
+    convertToMinimumPhase ();
+
+  // unity gain at the centre of the band
+  const double gain = std::abs (response (std::min (std::max (centerFrequency, 0.0), 0.5)));
+  if (gain > 0)
+    for (auto& tap : m_taps)
+      tap /= gain;
+
+  m_delay.assign (2 * m_numTaps, 0);
+  m_pos = 0;
+}
+
+void BandPass::convertToMinimumPhase ()
+{
+  // the grid is fine enough that the folded cepstrum barely aliases
+  int n = 1;
+  while (n < 16 * m_numTaps)
+    n <<= 1;
+
+  std::vector<complex_t> a (n, 0.);
+  for (int i = 0; i < m_numTaps; i++)
+    a[i] = m_taps[i];
+  fft (a, false);
+
+  // log magnitude, floored in the stopband zeros
+  double peak = 0;
+  for (const auto& x : a)
+    peak = std::max (peak, std::abs (x));
+  const double floor = std::max (peak, 1e-300) * 1e-8;
+  for (auto& x : a)
+    x = std::log (std::max (std::abs (x), floor));
+  fft (a, true);
+
+  // keep the causal part of the real cepstrum: c[0], 2 c[k], c[n/2]
+  a[0] /= n;
+  for (int i = 1; i < n / 2; i++)
+    a[i] *= 2.0 / n;
+  a[n / 2] /= n;
+  for (int i = n / 2 + 1; i < n; i++)
+    a[i] = 0;
+
+  fft (a, false);
+  for (auto& x : a)
+    x = std::exp (x);
+  fft (a, true);
+
+  for (int i = 0; i < m_numTaps; i++)
+    m_taps[i] = a[i].real () / n;
+}
+
+int BandPass::numTapsForTransition (double transitionWidth)
+{
+  // Hamming window: transition width ~ 3.3 / N
+  if (transitionWidth <= 0) return 1;
+  return (int)ceil (3.3 / transitionWidth) | 1;
+}
+
+void BandPass::reset ()
+{
+  std::fill (m_delay.begin (), m_delay.end (), 0);
+  m_pos = 0;
+}
+
+double BandPass::groupDelay (double normalizedFrequency) const
+{
+  if (!m_minimumPhase)
+    return (m_numTaps - 1) / 2.0;
+
+  // Re(sum n h[n] z^-n / H(z)) on the unit circle
+  const double w = 2 * doublePi * normalizedFrequency;
+  complex_t h (0);
+  complex_t nh (0);
+  for (int i = 0; i < m_numTaps; i++)
+  {
+    const complex_t z = std::polar (1., -w * i);
+    h = addmul (h, m_taps[i], z);
+    nh = addmul (nh, i * m_taps[i], z);
+  }
+  if (std::abs (h) == 0)
+    return 0;
+  return (nh / h).real ();
+}
+
+complex_t BandPass::response (double normalizedFrequency) const
+{
+  const double w = 2 * doublePi * normalizedFrequency;
+  complex_t ch (0);
+  for (int i = 0; i < m_numTaps; i++)
+    ch = addmul (ch, m_taps[i], std::polar (1., -w * i));
+  return ch;
+}
+
+}
+
+}
@@ -0,0 +1,156 @@
+/**
+ *
+ * "A Collection of Useful C++ Classes for Digital Signal Processing"
+ * By Vinnie Falco and Bernd Porr
+ *
+ * Official project location:
+ * https://github.com/berndporr/iir1
+ *
+ * See Documentation.txt for contact information, notes, and bibliography.
+ * 
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ * Copyright (c) 2009 by Vinnie Falco
+ * Copyright (c) 2011-2021 by Bernd Porr
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+
+#ifndef IIR1_FIR_H
+#define IIR1_FIR_H
+
+#include "Common.h"
+#include "MathSupplement.h"
+
+namespace Iir {
+
+/**
+ * Short linear phase FIR filters (windowed sinc with a Hamming window).
+ * The group delay is (numTaps - 1) / 2 samples at every frequency, so
+ * the shape of a burst is not distorted, at the cost of a delay that
+ * grows with the selectivity.
+ *
+ * The minimum phase variant has the same magnitude response, obtained
+ * from the linear phase taps by folding their real cepstrum. Its energy
+ * is packed at the start of the impulse response, so the delay in the
+ * passband is a fraction of (numTaps - 1) / 2, but it depends on the
+ * frequency and the burst shape is no longer preserved.
+ **/
+namespace FIR {
+
+	/**
+	 * Linear phase bandpass
+	 **/
+	class IIR_EXPORT BandPass
+	{
+	public:
+		BandPass () = default;
+
+		/**
+		 * Calculates the coefficients
+		 * \param sampleRate Sampling rate
+		 * \param centerFrequency Centre frequency of the bandpass
+		 * \param widthFrequency Width of the bandpass
+		 * \param numTaps Length of the filter, rounded up to an odd number
+		 * \param minimumPhase Convert the taps to minimum phase
+		 **/
+		void setup (double sampleRate,
+			    double centerFrequency,
+			    double widthFrequency,
+			    int numTaps,
+			    bool minimumPhase = false) {
+			setupN (centerFrequency / sampleRate, widthFrequency / sampleRate, numTaps, minimumPhase);
+		}
+
+		/**
+		 * Calculates the coefficients
+		 * \param centerFrequency Normalised centre frequency (0..1/2) of the bandpass
+		 * \param widthFrequency Width of the bandpass in normalised freq
+		 * \param numTaps Length of the filter, rounded up to an odd number
+		 * \param minimumPhase Convert the taps to minimum phase
+		 **/
+		void setupN (double centerFrequency,
+			     double widthFrequency,
+			     int numTaps,
+			     bool minimumPhase = false);
+
+		/**
+		 * Number of taps needed for a given normalised transition width
+		 **/
+		static int numTapsForTransition (double transitionWidth);
+
+		/**
+		 * Resets the delay line to zero
+		 **/
+		void reset ();
+
+		/**
+		 * Filter one sample
+		 * \param s Sample to be filtered
+		 * \return Filtered sample
+		 **/
+		template <typename Sample>
+		inline Sample filter (Sample s) {
+			// every sample is written twice so the taps always see a contiguous window
+			m_pos = (m_pos == 0) ? m_numTaps - 1 : m_pos - 1;
+			m_delay[m_pos] = m_delay[m_pos + m_numTaps] = static_cast<double>(s);
+			const double* x = m_delay.data () + m_pos;
+			double out = 0;
+			for (int i = 0; i < m_numTaps; i++)
+				out += m_taps[i] * x[i];
+			return static_cast<Sample>(out);
+		}
+
+		/**
+		 * Calculate filter response at the given normalized frequency
+		 * \param normalizedFrequency Frequency from 0 to 0.5 (Nyquist)
+		 **/
+		complex_t response (double normalizedFrequency) const;
+
+		/**
+		 * The group delay in samples at the given normalized frequency,
+		 * the same at every frequency for linear phase
+		 **/
+		double groupDelay (double normalizedFrequency) const;
+
+		bool isMinimumPhase () const {
+			return m_minimumPhase;
+		}
+
+		int getNumTaps () const {
+			return m_numTaps;
+		}
+
+	private:
+		void convertToMinimumPhase ();
+
+		bool m_minimumPhase = false;
+		int m_numTaps = 1;
+		int m_pos = 0;
+		std::vector<double> m_taps = {1};
+		std::vector<double> m_delay = {0, 0};
+	};
+
+}
+
+}
+
+#endif
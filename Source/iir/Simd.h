@@ -0,0 +1,48 @@
+/**
+ *
+ * Multiversioning macros shared by the multichannel and block kernels.
+ *
+ * -----------------------------------------------------------------
+ *
+ * License: MIT License (http://www.opensource.org/licenses/mit-license.php)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ **/
+
+#ifndef IIR1_SIMD_H
+#define IIR1_SIMD_H
+
+// Runtime dispatch between AVX-512, AVX2 and the baseline build where the
+// toolchain supports function multiversioning. Elsewhere the compiler's
+// default vectorization (SSE2 / NEON) is used. The ifunc resolvers run
+// before ThreadSanitizer is set up, so its builds take the baseline.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && \
+	!defined(__SANITIZE_THREAD__)
+#define IIR_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define IIR_SIMD_CLONES
+#endif
+
+#if defined(_MSC_VER)
+#define IIR_RESTRICT __restrict
+#else
+#define IIR_RESTRICT __restrict__
+#endif
+
+#endif
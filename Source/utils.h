@@ -6,10 +6,17 @@
 #endif
 #include <vector>
 #include <complex>
+#include <memory>
+
+#include "ComplexDemodulator.h"
+#include "FFT.h"
+#include "iir/Butterworth.h"
 
 
 enum ThresholdType { CONSTANT = 0, AUTO };
-enum SdftType { RECTANGLE = 1, EXP, ZeroPaddingExp, MirrorExp};
+// values are saved with the parameters: AutoEngine keeps 6, new engines go after it
+enum SdftType { RECTANGLE = 1, EXP, ZeroPaddingExp, MirrorExp, HoppedSTFT, AutoEngine, ConstantQ, HilbertEnvelope, ComplexDemod, MultiWindow, SDFT_TYPES };
+enum SpatialReference { NO_REFERENCE = 0, CAR, CMR };
 
 
 class Smooth
@@ -26,17 +33,20 @@ private:
 };
 
 
+// RMS over the last nsamp samples, O(1) per sample; the running sum of
+// squares is summed afresh once per window so rounding cannot pile up
 class RMS
 {
 public:
 	RMS(int nsamp = 500);
 	void setSize(int nsamp);
+	int getSize();
 	void addSample(double sample);
 	double getRes();
 	void clear();
 
 private:
-	//juce::Array<double> buffer;
+	std::vector<double> buffer;	// squares
 	int size;
 	int index;
 	double ss;
@@ -65,11 +75,11 @@ class SmoothList
 {
 public:
 	SmoothList(int num = 10, double k = 0.9);
-	~SmoothList();
 	void setN(int num);
-	void addSamples(std::vector<double> data);
+	void addSamples(const std::vector<double>& data);
 	void setK(double k);
 	std::vector<double> getRes();
+	void getRes(std::vector<double>& res);
 	void clear();
 	int num;
 
@@ -83,10 +93,10 @@ class STDList
 {
 public:
 	STDList(int num = 10);
-	~STDList();
 	void setN(int num);
-	void addSamples(std::vector<double> data);
+	void addSamples(const std::vector<double>& data);
 	std::vector<double> getResN(float n);
+	void getResN(float n, std::vector<double>& res);
 	void clear();
 	int num;
 
@@ -94,6 +104,16 @@ public:
 };
 
 
+class TwiddleCache
+{
+public:
+	typedef std::vector<std::complex<double>> Table;
+
+	// exp(j 2 pi k / nfft), k = 0..nfft-1; one immutable table per nfft, shared by all instances
+	static std::shared_ptr<const Table> get(int nfft);
+};
+
+
 class RealtimeSDFT
 {
 public:
@@ -106,15 +126,20 @@ public:
 	int n;
 	int n_out;
 	std::vector<int> steps;
-	std::vector<std::complex<double>> coefs;
+	std::shared_ptr<const TwiddleCache::Table> twiddles;
+	const std::complex<double>* coefs;
 	int index;
-	std::vector<std::complex<double>> sample;
+	// real input ring; bin state only for min_idx..max_idx, indexed from 0
+	std::vector<double> sample;
 	std::vector<std::complex<double>> fftout;
+	// band power as mean |X|^2 / nfft^2 instead of mean |X| / nfft (no sqrt per bin)
+	bool powerDomain = false;
 	virtual void init(int fmin, int fmax, int nfft, int sampleRate);
 
 
 	RealtimeSDFT(int fmin = 4, int fmax = 8, int nfft = 512, int sampleRate = 1000);
 	virtual ~RealtimeSDFT() = default;
+	void configure(int fmin, int fmax, int nfft, int sampleRate);
 	virtual void setNfft(int SDFT_nfft);
 	virtual void setFreqs(int FreqMin, int FreqMax);
 	virtual void setSampleRate(int samplerate);
@@ -122,7 +147,13 @@ public:
 	virtual void addSample(double sample);
 	double getBandPower();
 	std::vector<double> getBandPowerList();
+	void getBandPowerList(std::vector<double>& powers);
+	void setPowerDomain(bool powerDomain);
+	// band power is read every hop samples; per-sample engines ignore it
+	virtual void setHop(int hop);
 	int get_n();
+	// bytes owned by this instance, the shared twiddle table excluded
+	virtual size_t getMemoryFootprint() const;
 	SdftType type;
 };
 
@@ -137,7 +168,7 @@ public:
 	bool reset_label;
 	std::vector<std::complex<double>> fftout1_2;
 	std::vector<std::complex<double>> fftout2_2;
-	std::vector<std::complex<double>> sample_2;
+	std::vector<double> sample_2;
 	bool change_label = false;
 	int reset_count = 0;
 
@@ -147,7 +178,7 @@ public:
 
 	void addSample(double in_sample) override;
 
-	void addSampleReset(std::complex<double> in_sample);
+	void addSampleReset(double in_sample);
 
 	double getFFTout1();
 
@@ -157,6 +188,7 @@ public:
 	void setFreqs(int FreqMin, int FreqMax) override;
 	void setSampleRate(int samplerate) override;
 	void clear() override;
+	size_t getMemoryFootprint() const override;
 };
 
 
@@ -165,8 +197,6 @@ public:
 	std::vector<std::complex<double>> fftout1;
 	std::vector<std::complex<double>> fftout2;
 	double tau_down, N2tau;
-	std::vector<std::complex<double>> coefs1;
-	std::vector<std::complex<double>> coefs2;
 	int PoolLength;
 
 	RealtimeMirrorExpSDFT(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
@@ -176,6 +206,7 @@ public:
 	void setSampleRate(int samplerate) override;
 	void addSample(double in_sample) override;
 	void clear() override;
+	size_t getMemoryFootprint() const override;
 };
 
 
@@ -187,6 +218,185 @@ public:
 	RealtimeZeroPaddingExpSDFT(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
 	void init(int fmin, int fmax, int nfft, int sampleRate) override;
 	void addSample(double in_sample) override;
+	size_t getMemoryFootprint() const override;
+};
+
+
+/*
+ * Hopped STFT: the input ring is Hann windowed and transformed every hop
+ * samples, computing only the band bins. Cheaper than the per-sample
+ * engines for wide bands and large hops, see estimateEngineCost.
+ * With hop 0 the ring is only transformed on transform().
+ */
+class RealtimeSTFT : public RealtimeSDFT {
+public:
+	RealtimeSTFT(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
+	void init(int fmin, int fmax, int nfft, int sampleRate) override;
+	void addSample(double in_sample) override;
+	void clear() override;
+	void setHop(int hop) override;
+	size_t getMemoryFootprint() const override;
+	void transform();
+	double getFrameRms() const;	// of the windowed frame of the last transform
+
+private:
+
+	int hop, hopCount;
+	std::vector<double> window, frame;
+	PrunedRealDFT dft;
+};
+
+
+/*
+ * Constant-Q sliding DFT: every band bin k keeps its own window of
+ * Q = max(min_idx, 1) cycles, N_k = nfft * Q / k samples, so the lowest bin
+ * uses the full nfft and higher bins react proportionally faster. All bins
+ * read their oldest sample from one shared ring of nfft samples:
+ * X_k(t) = z_k X_k(t-1) + g_k (x(t) - z_k^N_k x(t - N_k)), z_k = exp(j 2 pi k / nfft),
+ * with g_k = nfft / N_k so that every bin reads on the scale of a full window.
+ */
+class RealtimeConstantQ : public RealtimeSDFT {
+public:
+	RealtimeConstantQ(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
+	void init(int fmin, int fmax, int nfft, int sampleRate) override;
+	void addSample(double in_sample) override;
+	size_t getMemoryFootprint() const override;
+
+	int getWindowLength(int bin) const;	// band bin, from 0
+
+private:
+	std::vector<int> lags;
+	std::vector<double> gains;
+	std::vector<std::complex<double>> tails;
+};
+
+
+/*
+ * Sliding DFT over several window lengths at once: nfft, nfft / 2, ...
+ * (WINDOWS of them), every one on the band bins of the full window and read
+ * on its scale, as in RealtimeConstantQ. All windows read their oldest
+ * sample from one shared ring of nfft samples and their bins are updated in
+ * one pass. The band power list is window-major: get_n() / WINDOWS bands of
+ * the full window first, then the same bands of each shorter window.
+ */
+class RealtimeMultiWindowSDFT : public RealtimeSDFT {
+public:
+	static const int WINDOWS = 3;
+
+	RealtimeMultiWindowSDFT(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
+	void init(int fmin, int fmax, int nfft, int sampleRate) override;
+	void addSample(double in_sample) override;
+	size_t getMemoryFootprint() const override;
+
+	int getWindowLength(int window) const;
+
+private:
+	int bins;	// band bins per window
+	std::vector<int> lags;
+	std::vector<double> gains;
+	std::vector<std::complex<double>> tails;	// z_k^N per window and bin
+};
+
+
+/*
+ * Narrow band envelope without a transform: a Butterworth bandpass over
+ * fmin..fmax followed by an all-pass pair whose outputs are 90 degrees
+ * apart, giving the analytic signal. About 20 multiply-adds per sample
+ * whatever the window length. The band power list has a single entry,
+ * scaled like the SDFTs (amplitude / 2). Bands narrower than one SDFT bin
+ * are widened to rfs / nfft.
+ */
+class RealtimeHilbert : public RealtimeSDFT {
+public:
+	RealtimeHilbert(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
+	void init(int fmin, int fmax, int nfft, int sampleRate) override;
+	void addSample(double in_sample) override;
+	void clear() override;
+	size_t getMemoryFootprint() const override;
+
+	double getEnvelope() const;
+	double getPhase() const;	// radians
+
+private:
+	static const int ALLPASS_STAGES = 4;
+	struct AllpassState {
+		double x1, x2, y1, y2;
+	};
+	static double allpassChain(const double* coefficients, AllpassState* states, double x);
+
+	Iir::Butterworth::BandPass<2> bandpass;
+	AllpassState realPath[ALLPASS_STAGES], imagPath[ALLPASS_STAGES];
+	double realDelay;
+	std::complex<double> analytic;
+};
+
+
+/*
+ * Band power by complex demodulation: mixed down at the band centre and
+ * CIC low-passed (ComplexDemodulator on one channel), with a new output
+ * every hop samples. The CIC window is set so its -3 dB point sits at half
+ * the band width, widened to rfs / nfft for bands narrower than one bin.
+ * One band power entry, scaled like the SDFTs (amplitude / 2).
+ */
+class RealtimeDemodulator : public RealtimeSDFT {
+public:
+	RealtimeDemodulator(int fmin = 4, int fmax = 8, int nfft = 1000, int sampleRate = 1000);
+	void init(int fmin, int fmax, int nfft, int sampleRate) override;
+	void addSample(double in_sample) override;
+	void clear() override;
+	void setHop(int hop) override;
+	size_t getMemoryFootprint() const override;
+
+	double getEnvelope() const;
+	// band phase extrapolated to the current sample at the centre frequency
+	double getPhase() const;
+
+private:
+	void setupDemodulator();
+
+	int hop;
+	double center;
+	int windowLength;
+	ComplexDemodulator demodulator;
+};
+
+
+// estimated cost in flops per input sample of an engine for the given band, window and hop,
+// including reading the band power once per hop
+double estimateEngineCost(SdftType type, int fmin, int fmax, int nfft, int sampleRate, int hop);
+
+
+/*
+ * Engine profiles for this CPU, measured once per process on first use.
+ * Timing every engine on a reference band turns estimateEngineCost into
+ * ns per sample, and an impulse through every engine gives its frequency
+ * resolution (equivalent noise bandwidth) and latency (window centroid).
+ */
+class EngineSelector
+{
+public:
+	struct Profile {
+		double nsPerCost;
+		double enbwBins;
+		double centroid;	// fraction of nfft
+	};
+
+	static const EngineSelector& get();
+	static std::unique_ptr<RealtimeSDFT> create(SdftType type);
+	static const char* getName(SdftType type);
+
+	double costNs(SdftType type, int fmin, int fmax, int nfft, int sampleRate, int hop) const;
+	double resolutionHz(SdftType type, int nfft, int sampleRate) const;
+	double latencyMs(SdftType type, int nfft, int sampleRate, int hop) const;
+
+	// cheapest engine that resolves fmax - fmin within the latency budget (ms, 0: none);
+	// otherwise the lowest latency engine that resolves the band, otherwise RECTANGLE
+	SdftType select(int fmin, int fmax, int nfft, int sampleRate, int hop, double latencyBudget) const;
+
+private:
+	EngineSelector();
+
+	Profile profiles[SdftType::SDFT_TYPES];
 };
 
 
@@ -204,3 +414,41 @@ private:
 	std::vector<double> buffer_;
 };
 
+
+
+/*
+ * Block-wise spatial stage: re-references the selected channels (CAR/CMR)
+ * and combines them into one or more virtual channels with a weight matrix.
+ * All loops run channel-major over contiguous sample buffers.
+ */
+class SpatialFilter {
+public:
+	SpatialFilter();
+	void setChannels(const std::vector<int>& channels);
+	void setReference(SpatialReference reference);
+	void setWeights(const std::vector<std::vector<float>>& weights);
+	void setWeightRow(int k, const std::vector<float>& row);
+	static std::vector<std::vector<float>> parseWeights(const std::string& text);
+
+	// computes the samples start, start + step, ... < nSamples of every output
+	int process(const float** data, int start, int nSamples, int step = 1);
+	const float* getOutput(int k) const;
+	const float* getReference() const;	// of the last process(), nullptr without one
+	int getNumOutputs() const;
+	int getNumChannels() const;
+
+private:
+	void updateWeights();
+	void computeReference(const float** data, int start, int n, int step);
+
+	SpatialReference reference;
+	std::vector<int> channels;
+	std::vector<std::vector<float>> requestedWeights;
+	std::vector<float> weights;		// nOutputs x nChannels, row-major
+	std::vector<float> weightSums;
+	std::vector<float> referenceBuffer;
+	std::vector<float> medianScratch;
+	std::vector<float> output;		// nOutputs x capacity
+	int nOutputs;
+	int capacity;
+};